@@ -0,0 +1,553 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Аллокатор поверх malloc/realloc. Большие буферы выделяются напрямую через mmap
+// и растут через mremap, поэтому ядро переносит страницы, а не копирует их.
+// RawMemory использует reallocate только для тривиально перемещаемых типов.
+template <typename T>
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    // Буферы от этого размера и больше выделяются страницами через mmap
+    static constexpr size_t MMAP_THRESHOLD = size_t{32} << 20;
+
+    MallocAllocator() noexcept = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+#ifdef __linux__
+        if (bytes >= MMAP_THRESHOLD) {
+            void* buf = mmap(nullptr, RoundToPages(bytes), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (buf == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(buf);
+        }
+#endif
+        void* buf = std::malloc(bytes);
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+#ifdef __linux__
+        if (IsMapped(n)) {
+            munmap(buf, RoundToPages(n * sizeof(T)));
+            return;
+        }
+#endif
+        std::free(buf);
+    }
+
+    // Меняет размер буфера, сохраняя побайтово первые min(old_n, new_n) элементов.
+    // При исключении исходный буфер остаётся нетронутым.
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+#ifdef __linux__
+        if (IsMapped(old_n) && IsMapped(new_n)) {
+            void* new_buf = mremap(buf, RoundToPages(old_n * sizeof(T)), RoundToPages(new_n * sizeof(T)),
+                                   MREMAP_MAYMOVE);
+            if (new_buf == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(new_buf);
+        }
+        if (IsMapped(old_n) || IsMapped(new_n)) {
+            // Переход между кучей и mmap: realloc здесь неприменим
+            T* new_buf = allocate(new_n);
+            std::memcpy(static_cast<void*>(new_buf), static_cast<const void*>(buf),
+                        std::min(old_n, new_n) * sizeof(T));
+            deallocate(buf, old_n);
+            return new_buf;
+        }
+#endif
+        void* new_buf = std::realloc(buf, new_n * sizeof(T));
+        if (new_buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_buf);
+    }
+
+    friend bool operator==(const MallocAllocator& /*lhs*/, const MallocAllocator& /*rhs*/) noexcept {
+        return true;
+    }
+
+private:
+#ifdef __linux__
+    static bool IsMapped(size_t n) noexcept {
+        return n * sizeof(T) >= MMAP_THRESHOLD;
+    }
+
+    static size_t RoundToPages(size_t bytes) noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page_size - 1) / page_size * page_size;
+    }
+#endif
+};
+
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+inline constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+// Аллокатор, выравнивающий начало буфера по Align байтам через выровненный operator new.
+// Выравнивание по CACHE_LINE_SIZE избавляет векторные циклы от загрузок через границу
+// кэш-линий, по HUGE_PAGE_SIZE — позволяет ядру отобразить буфер прозрачными huge pages.
+// Для самих over-aligned типов достаточно и std::allocator: он учитывает alignof(T).
+template <typename T, size_t Align = CACHE_LINE_SIZE>
+class AlignedAllocator {
+    static_assert(std::has_single_bit(Align), "Alignment must be a power of two");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_t ALIGNMENT = std::max(Align, alignof(T));
+
+    // Выравнивание — нетиповой параметр, поэтому allocator_traits не выведет rebind сам
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ALIGNMENT}));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        ::operator delete(buf, n * sizeof(T), std::align_val_t{ALIGNMENT});
+    }
+
+    friend bool operator==(const AlignedAllocator& /*lhs*/, const AlignedAllocator& /*rhs*/) noexcept {
+        return true;
+    }
+};
+
+// Подсказка ядру об использовании больших страниц
+enum class HugePages {
+    NONE,
+    // madvise(MADV_HUGEPAGE): прозрачные huge pages, буфер выравнивается по HUGE_PAGE_SIZE
+    TRANSPARENT,
+    // MAP_HUGETLB: заранее зарезервированные huge pages. Если их нет, используется TRANSPARENT
+    EXPLICIT,
+};
+
+// Размещение страниц буфера по узлам NUMA
+enum class NumaPolicy {
+    // Политика потока: страница попадает на узел потока, первым её коснувшегося
+    DEFAULT,
+    // Узел потока, выделившего буфер
+    LOCAL,
+    // Страницы по очереди на узлах из MmapOptions::nodes
+    INTERLEAVE,
+    // Только узлы из MmapOptions::nodes
+    BIND,
+};
+
+struct MmapOptions {
+    HugePages huge_pages = HugePages::TRANSPARENT;
+    NumaPolicy numa = NumaPolicy::DEFAULT;
+    // Бит i — узел i. Пустая маска для INTERLEAVE означает все доступные процессу узлы
+    uint64_t nodes = 0;
+
+    friend bool operator==(const MmapOptions& lhs, const MmapOptions& rhs) noexcept = default;
+};
+
+// Аллокатор для больших векторов: буферы от MMAP_THRESHOLD отображаются через mmap
+// с заданными подсказками о huge pages и политикой NUMA, меньшие берутся из malloc.
+// Политика применяется к отображению до первого касания, поэтому страницы размещаются
+// согласно ей, каким бы потоком вектор ни заполнялся, и сохраняется при росте через mremap.
+// Если ядро собрано без поддержки NUMA, политика игнорируется.
+// Параметры переходят вместе с буфером при копировании, перемещении и обмене векторов.
+template <typename T>
+class MmapAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    static constexpr size_t MMAP_THRESHOLD = size_t{32} << 20;
+
+    MmapAllocator() noexcept = default;
+
+    explicit MmapAllocator(const MmapOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    MmapAllocator(const MmapAllocator<U>& other) noexcept
+        : options_(other.GetOptions()) {
+    }
+
+    const MmapOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+#ifdef __linux__
+        if (IsMapped(n)) {
+            return static_cast<T*>(Map(n * sizeof(T)));
+        }
+#endif
+        void* buf = std::malloc(n * sizeof(T));
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+#ifdef __linux__
+        if (IsMapped(n)) {
+            munmap(buf, MappedSize(n * sizeof(T)));
+            return;
+        }
+#endif
+        std::free(buf);
+    }
+
+    // Как MallocAllocator::reallocate. Отображения с MAP_HUGETLB не переносятся через mremap,
+    // поскольку не все ядра это поддерживают
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+#ifdef __linux__
+        if (IsMapped(old_n) && IsMapped(new_n) && options_.huge_pages != HugePages::EXPLICIT) {
+            void* new_buf = mremap(buf, MappedSize(old_n * sizeof(T)), MappedSize(new_n * sizeof(T)),
+                                   MREMAP_MAYMOVE);
+            if (new_buf == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(new_buf);
+        }
+        if (IsMapped(old_n) || IsMapped(new_n)) {
+            T* new_buf = allocate(new_n);
+            std::memcpy(static_cast<void*>(new_buf), static_cast<const void*>(buf),
+                        std::min(old_n, new_n) * sizeof(T));
+            deallocate(buf, old_n);
+            return new_buf;
+        }
+#endif
+        void* new_buf = std::realloc(buf, new_n * sizeof(T));
+        if (new_buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_buf);
+    }
+
+    friend bool operator==(const MmapAllocator& lhs, const MmapAllocator& rhs) noexcept {
+        return lhs.options_ == rhs.options_;
+    }
+
+private:
+#ifdef __linux__
+    // Значения MPOL_* из <linux/mempolicy.h>: заголовки libnuma могут отсутствовать
+    enum MemPolicyMode : int {
+        MPOL_DEFAULT_MODE = 0,
+        MPOL_BIND_MODE = 2,
+        MPOL_INTERLEAVE_MODE = 3,
+        MPOL_LOCAL_MODE = 4,
+    };
+    static constexpr unsigned long MPOL_F_MEMS_ALLOWED_FLAG = 1 << 2;
+
+    static bool IsMapped(size_t n) noexcept {
+        return n * sizeof(T) >= MMAP_THRESHOLD;
+    }
+
+    size_t MappedSize(size_t bytes) const noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t granularity = options_.huge_pages == HugePages::NONE ? page_size : HUGE_PAGE_SIZE;
+        return (bytes + granularity - 1) / granularity * granularity;
+    }
+
+    void* Map(size_t bytes) const {
+        const size_t size = MappedSize(bytes);
+        void* buf = MAP_FAILED;
+        if (options_.huge_pages == HugePages::EXPLICIT) {
+            buf = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+        if (buf == MAP_FAILED && options_.huge_pages != HugePages::NONE) {
+            buf = MapAligned(size, HUGE_PAGE_SIZE);
+            if (buf != nullptr) {
+                madvise(buf, size, MADV_HUGEPAGE);
+            }
+        } else if (buf == MAP_FAILED) {
+            buf = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            buf = buf == MAP_FAILED ? nullptr : buf;
+        }
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (!ApplyNumaPolicy(buf, size)) {
+            munmap(buf, size);
+            throw std::bad_alloc();
+        }
+        return buf;
+    }
+
+    // Отображает с запасом и обрезает края, чтобы начало было выровнено по alignment
+    static void* MapAligned(size_t size, size_t alignment) noexcept {
+        void* raw = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (begin + alignment - 1) / alignment * alignment;
+        if (aligned != begin) {
+            munmap(raw, aligned - begin);
+        }
+        if (const size_t tail = begin + alignment - aligned; tail != 0) {
+            munmap(reinterpret_cast<void*>(aligned + size), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    bool ApplyNumaPolicy(void* buf, size_t size) const noexcept {
+        int mode = MPOL_DEFAULT_MODE;
+        unsigned long nodes = static_cast<unsigned long>(options_.nodes);
+        switch (options_.numa) {
+            case NumaPolicy::DEFAULT:
+                return true;
+            case NumaPolicy::LOCAL:
+                mode = MPOL_LOCAL_MODE;
+                nodes = 0;
+                break;
+            case NumaPolicy::INTERLEAVE:
+                mode = MPOL_INTERLEAVE_MODE;
+                if (nodes == 0) {
+                    int current_mode = 0;
+                    if (syscall(SYS_get_mempolicy, &current_mode, &nodes, sizeof(nodes) * 8 + 1, nullptr,
+                                MPOL_F_MEMS_ALLOWED_FLAG)
+                        != 0) {
+                        return errno == ENOSYS;
+                    }
+                }
+                break;
+            case NumaPolicy::BIND:
+                mode = MPOL_BIND_MODE;
+                break;
+        }
+        // Ядро считает maxnode на единицу больше числа значащих битов маски
+        const unsigned long max_node = nodes == 0 ? 0 : sizeof(nodes) * 8 + 1;
+        if (syscall(SYS_mbind, buf, size, mode, nodes == 0 ? nullptr : &nodes, max_node, 0u) != 0) {
+            return errno == ENOSYS;
+        }
+        return true;
+    }
+#endif
+
+    MmapOptions options_;
+};
+
+namespace detail {
+
+enum class BufferCacheState : unsigned char {
+    NOT_CREATED,
+    ALIVE,
+    DESTROYED,
+};
+
+// Кэш потока уничтожается раньше статических объектов, поэтому освобождения после этого
+// идут мимо кэша. Переменная тривиальна и не уничтожается сама.
+inline thread_local BufferCacheState buffer_cache_state = BufferCacheState::NOT_CREATED;
+
+}  // namespace detail
+
+// Кэш недавно освобождённых буферов текущего потока. Буферы разбиты на классы по размеру:
+// класс k хранит буферы по MIN_BUFFER_BYTES << k байт, и запрос округляется вверх до класса.
+// Буферы больше MAX_BUFFER_BYTES и сверх лимита кэша возвращаются в operator delete.
+// Буфер, освобождённый в другом потоке, попадает в кэш того потока; если кэша там
+// ещё нет, он создаётся при первом освобождении.
+class BufferCache {
+public:
+    static constexpr size_t MIN_BUFFER_BYTES = 64;
+    static constexpr size_t NUM_CLASSES = 15;
+    static constexpr size_t MAX_BUFFER_BYTES = MIN_BUFFER_BYTES << (NUM_CLASSES - 1);
+    static constexpr size_t DEFAULT_LIMIT = size_t{4} << 20;
+
+    BufferCache(const BufferCache&) = delete;
+    BufferCache& operator=(const BufferCache&) = delete;
+
+    ~BufferCache() {
+        Trim(0);
+        detail::buffer_cache_state = detail::BufferCacheState::DESTROYED;
+    }
+
+    // Кэш текущего потока
+    static BufferCache& Local() {
+        thread_local BufferCache cache;
+        return cache;
+    }
+
+    static void* Allocate(size_t bytes) {
+        if (bytes > MAX_BUFFER_BYTES || detail::buffer_cache_state == detail::BufferCacheState::DESTROYED) {
+            return ::operator new(bytes);
+        }
+        return Local().Pop(ClassOf(bytes));
+    }
+
+    static void Deallocate(void* buf, size_t bytes) noexcept {
+        if (bytes > MAX_BUFFER_BYTES || detail::buffer_cache_state == detail::BufferCacheState::DESTROYED) {
+            ::operator delete(buf);
+            return;
+        }
+        Local().Push(buf, ClassOf(bytes));
+    }
+
+    // Наибольший суммарный объём хранимых буферов. Лишние буферы освобождаются сразу.
+    void SetLimit(size_t max_cached_bytes) noexcept {
+        limit_ = max_cached_bytes;
+        Trim(limit_);
+    }
+
+    size_t Limit() const noexcept {
+        return limit_;
+    }
+
+    // Освобождает буферы, начиная с самых больших, пока в кэше не останется не больше max_cached_bytes
+    void Trim(size_t max_cached_bytes = 0) noexcept {
+        for (size_t size_class = NUM_CLASSES; size_class-- > 0 && cached_bytes_ > max_cached_bytes;) {
+            while (free_[size_class] != nullptr && cached_bytes_ > max_cached_bytes) {
+                FreeBuffer* buf = free_[size_class];
+                free_[size_class] = buf->next;
+                cached_bytes_ -= ClassBytes(size_class);
+                ::operator delete(static_cast<void*>(buf));
+            }
+        }
+    }
+
+    size_t CachedBytes() const noexcept {
+        return cached_bytes_;
+    }
+
+    // Число выделений, обслуженных кэшем и мимо него
+    size_t Hits() const noexcept {
+        return hits_;
+    }
+
+    size_t Misses() const noexcept {
+        return misses_;
+    }
+
+private:
+    // Освобождённый буфер хранит указатель на следующий буфер своего класса
+    struct FreeBuffer {
+        FreeBuffer* next;
+    };
+
+    BufferCache() noexcept {
+        detail::buffer_cache_state = detail::BufferCacheState::ALIVE;
+    }
+
+    static size_t ClassOf(size_t bytes) noexcept {
+        return bytes <= MIN_BUFFER_BYTES ? 0 : std::bit_width(bytes - 1) - std::bit_width(MIN_BUFFER_BYTES - 1);
+    }
+
+    static size_t ClassBytes(size_t size_class) noexcept {
+        return MIN_BUFFER_BYTES << size_class;
+    }
+
+    void* Pop(size_t size_class) {
+        if (FreeBuffer* buf = free_[size_class]) {
+            free_[size_class] = buf->next;
+            cached_bytes_ -= ClassBytes(size_class);
+            ++hits_;
+            return buf;
+        }
+        ++misses_;
+        return ::operator new(ClassBytes(size_class));
+    }
+
+    void Push(void* buf, size_t size_class) noexcept {
+        if (cached_bytes_ + ClassBytes(size_class) > limit_) {
+            ::operator delete(buf);
+            return;
+        }
+        free_[size_class] = ::new (buf) FreeBuffer{free_[size_class]};
+        cached_bytes_ += ClassBytes(size_class);
+    }
+
+    FreeBuffer* free_[NUM_CLASSES] = {};
+    size_t cached_bytes_ = 0;
+    size_t limit_ = DEFAULT_LIMIT;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+// Аллокатор, берущий буферы из BufferCache текущего потока. Подключается заменой
+// аллокатора в типе вектора: Vector<T, CachingAllocator<T>>.
+template <typename T>
+class CachingAllocator {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned types are not supported");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    CachingAllocator() noexcept = default;
+
+    template <typename U>
+    CachingAllocator(const CachingAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(BufferCache::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        BufferCache::Deallocate(buf, n * sizeof(T));
+    }
+
+    friend bool operator==(const CachingAllocator& /*lhs*/, const CachingAllocator& /*rhs*/) noexcept {
+        return true;
+    }
+};
@@ -0,0 +1,284 @@
+// Сравнение Vector и std::vector на типичных операциях.
+// Сборка: g++ -std=c++20 -O2 -DNDEBUG benchmark.cpp -o benchmark
+// Запуск: ./benchmark [максимальный размер, по умолчанию 1000000]
+#include "vector.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Счётчик выделений памяти через глобальный operator new
+size_t num_allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++num_allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+using namespace std::literals;
+
+// Типы элементов: тривиальный, с noexcept-перемещением, с бросающим перемещением
+// (при росте вектор копирует такие элементы) и большой тривиальный
+using Trivial = uint64_t;
+
+struct NothrowMovable {
+    NothrowMovable() = default;
+
+    explicit NothrowMovable(size_t i)
+        : value(std::to_string(i) + " is long enough to be allocated on the heap"s) {
+    }
+
+    std::string value;
+};
+
+struct ThrowingMove {
+    ThrowingMove() = default;
+
+    explicit ThrowingMove(size_t i)
+        : value(std::to_string(i) + " is long enough to be allocated on the heap"s) {
+    }
+
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : value(std::move(other.value)) {
+    }
+
+    ThrowingMove& operator=(ThrowingMove&& other) noexcept(false) {
+        value = std::move(other.value);
+        return *this;
+    }
+
+    std::string value;
+};
+
+struct Large {
+    Large() = default;
+
+    explicit Large(size_t i) {
+        data.fill(static_cast<char>(i));
+    }
+
+    std::array<char, 256> data{};
+};
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return static_cast<T>(i);
+    } else {
+        return T(i);
+    }
+}
+
+// Единый интерфейс для обоих контейнеров
+template <typename T>
+void PushBack(std::vector<T>& v, T value) {
+    v.push_back(std::move(value));
+}
+
+template <typename T>
+void PushBack(Vector<T>& v, T value) {
+    v.PushBack(std::move(value));
+}
+
+template <typename T>
+void EmplaceAt(std::vector<T>& v, size_t index, T value) {
+    v.emplace(v.begin() + index, std::move(value));
+}
+
+template <typename T>
+void EmplaceAt(Vector<T>& v, size_t index, T value) {
+    v.Emplace(v.cbegin() + index, std::move(value));
+}
+
+template <typename T>
+void EraseAt(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T>
+void EraseAt(Vector<T>& v, size_t index) {
+    v.Erase(v.cbegin() + index);
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename Container>
+size_t SizeOf(const Container& v) {
+    if constexpr (requires { v.size(); }) {
+        return v.size();
+    } else {
+        return v.Size();
+    }
+}
+
+template <typename Container, typename T>
+Container MakeFilled(size_t size) {
+    Container v;
+    Reserve(v, size);
+    for (size_t i = 0; i < size; ++i) {
+        PushBack(v, MakeValue<T>(i));
+    }
+    return v;
+}
+
+// Пиковый RSS процесса. Запись "5" в /proc/self/clear_refs сбрасывает пик (VmHWM),
+// что позволяет измерять его отдельно для каждого замера.
+void ResetPeakRss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs) {
+        clear_refs << "5";
+    }
+}
+
+size_t PeakRssKib() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoul(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+struct Measurement {
+    double ns_per_op = 0;
+    double allocations_per_run = 0;
+    size_t peak_rss_kib = 0;
+};
+
+// Повторяет run, пока измеренное время не превысит MIN_TIME, а общее (вместе с setup) —
+// MAX_WALL_TIME. setup выполняется перед каждым запуском и в замер не входит.
+// run возвращает число выполненных операций.
+template <typename Setup, typename Run>
+Measurement Measure(Setup setup, Run run) {
+    const auto MIN_TIME = 100ms;
+    const auto MAX_WALL_TIME = 2s;
+    const size_t MAX_RUNS = 1000;
+    std::chrono::nanoseconds total{0};
+    size_t total_ops = 0;
+    size_t total_allocations = 0;
+    size_t runs = 0;
+    ResetPeakRss();
+    const auto wall_start = std::chrono::steady_clock::now();
+    while (runs == 0
+           || (total < MIN_TIME && runs < MAX_RUNS && std::chrono::steady_clock::now() - wall_start < MAX_WALL_TIME)) {
+        auto state = setup();
+        const size_t allocations_before = num_allocations;
+        const auto start = std::chrono::steady_clock::now();
+        total_ops += run(state);
+        total += std::chrono::steady_clock::now() - start;
+        total_allocations += num_allocations - allocations_before;
+        ++runs;
+    }
+    return {static_cast<double>(total.count()) / static_cast<double>(std::max<size_t>(total_ops, 1)),
+            static_cast<double>(total_allocations) / static_cast<double>(runs), PeakRssKib()};
+}
+
+template <typename Container, typename T>
+Measurement RunOperation(std::string_view operation, size_t size) {
+    if (operation == "push_back"sv) {
+        return Measure([] { return Container{}; },
+                       [size](Container& v) {
+                           for (size_t i = 0; i < size; ++i) {
+                               PushBack(v, MakeValue<T>(i));
+                           }
+                           return size;
+                       });
+    }
+    if (operation == "emplace_front"sv || operation == "emplace_middle"sv) {
+        const bool front = operation == "emplace_front"sv;
+        return Measure([size] { return MakeFilled<Container, T>(size); },
+                       [front](Container& v) {
+                           EmplaceAt(v, front ? 0 : SizeOf(v) / 2, MakeValue<T>(0));
+                           return size_t{1};
+                       });
+    }
+    if (operation == "erase_front"sv) {
+        return Measure([size] { return MakeFilled<Container, T>(size); },
+                       [](Container& v) {
+                           EraseAt(v, 0);
+                           return size_t{1};
+                       });
+    }
+    if (operation == "copy_assign"sv) {
+        const Container source = MakeFilled<Container, T>(size);
+        return Measure([&source] { return MakeFilled<Container, T>(SizeOf(source) / 2); },
+                       [&source](Container& v) {
+                           v = source;
+                           return SizeOf(source);
+                       });
+    }
+    // reserve: перенос заполненного вектора в буфер вдвое большего размера
+    return Measure([size] { return MakeFilled<Container, T>(size); },
+                   [size](Container& v) {
+                       Reserve(v, size * 2);
+                       return size;
+                   });
+}
+
+template <typename T>
+void RunType(std::string_view type_name, size_t max_size) {
+    constexpr std::string_view OPERATIONS[] = {"push_back"sv,   "emplace_front"sv, "emplace_middle"sv,
+                                               "erase_front"sv, "copy_assign"sv,   "reserve"sv};
+    // Ограничение на память: не больше ~4 ГиБ на контейнер
+    const size_t size_limit = std::min(max_size, (size_t{4} << 30) / sizeof(T));
+    for (std::string_view operation : OPERATIONS) {
+        for (size_t size = 1; size <= size_limit; size *= 10) {
+            const Measurement actual = RunOperation<Vector<T>, T>(operation, size);
+            const Measurement expected = RunOperation<std::vector<T>, T>(operation, size);
+            std::printf("%-15s %-15s %10zu | %12.2f %10.1f %10zu | %12.2f %10.1f %10zu\n",
+                        std::string(operation).c_str(), std::string(type_name).c_str(), size, actual.ns_per_op,
+                        actual.allocations_per_run, actual.peak_rss_kib, expected.ns_per_op,
+                        expected.allocations_per_run, expected.peak_rss_kib);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t max_size = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+    std::printf("%-15s %-15s %10s | %12s %10s %10s | %12s %10s %10s\n", "operation", "type", "size",
+                "Vector ns/op", "allocs", "peak KiB", "std ns/op", "allocs", "peak KiB");
+    RunType<Trivial>("trivial", max_size);
+    RunType<NothrowMovable>("nothrow_move", max_size);
+    RunType<ThrowingMove>("throwing_move", max_size);
+    RunType<Large>("large", max_size);
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "segments.h"
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Вектор, в который могут одновременно добавлять элементы многие потоки. Место под элемент
+// резервируется атомарным счётчиком, элементы живут в сегментах RawMemory геометрически
+// растущего размера, поэтому рост не перемещает элементы и ссылки на них остаются
+// действительными. EmplaceBack свободен от блокировок: новый сегмент выделяют все дошедшие
+// до него потоки, публикует его первый, остальные освобождают свою память.
+//
+// Size() — длина префикса полностью созданных элементов. Элементы с индексами меньше Size()
+// можно читать одновременно с добавлением новых. Перемещение, копирование и очистка
+// не поддерживаются: объект существует, пока с ним работают потоки.
+//
+// Исключение из конструктора элемента или нехватка памяти завершают программу через
+// std::terminate: зарезервированное место нельзя вернуть, не останавливая другие потоки.
+template <typename T, size_t FirstSegmentSize = 64>
+class ConcurrentVector {
+    using Segments = detail::GeometricSegments<FirstSegmentSize>;
+
+    // Элемент и признак того, что он создан
+    struct Slot {
+        alignas(T) std::byte storage[sizeof(T)];
+        std::atomic<bool> ready{false};
+
+        T* Get() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+public:
+    ConcurrentVector() noexcept = default;
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        const size_t reserved = reserved_.load(std::memory_order_relaxed);
+        for (size_t index = 0; index < reserved; ++index) {
+            std::destroy_at(SlotAt(index).Get());
+        }
+        for (size_t segment = 0; segment < Segments::MAX_SEGMENTS; ++segment) {
+            if (Slot* slots = segments_[segment].load(std::memory_order_relaxed)) {
+                std::destroy_n(slots, Segments::SegmentSize(segment));
+            }
+        }
+    }
+
+    // Заранее выделяет сегменты для первых capacity элементов. Можно вызывать одновременно с EmplaceBack.
+    void Reserve(size_t capacity) noexcept {
+        for (size_t segment = 0; segment < Segments::MAX_SEGMENTS && Segments::SegmentStart(segment) < capacity;
+             ++segment) {
+            GetSegment(segment);
+        }
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) noexcept {
+        const size_t index = reserved_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = SlotAt(index);
+        T* value = std::construct_at(slot.Get(), std::forward<Args>(args)...);
+        slot.ready.store(true);
+        Publish();
+        return *value;
+    }
+
+    void PushBack(const T& value) noexcept {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) noexcept {
+        EmplaceBack(std::move(value));
+    }
+
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return *SlotAt(index).Get();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+private:
+    Slot& SlotAt(size_t index) noexcept {
+        const size_t segment = Segments::SegmentOf(index);
+        return GetSegment(segment)[Segments::OffsetOf(index, segment)];
+    }
+
+    Slot* GetSegment(size_t segment) noexcept {
+        if (Slot* slots = segments_[segment].load(std::memory_order_acquire)) {
+            return slots;
+        }
+        RawMemory<Slot> memory(Segments::SegmentSize(segment));
+        std::uninitialized_value_construct_n(memory.GetAddress(), Segments::SegmentSize(segment));
+        Slot* expected = nullptr;
+        if (segments_[segment].compare_exchange_strong(expected, memory.GetAddress(), std::memory_order_acq_rel)) {
+            // Буфер опубликован; владение им переходит в storage_, который читает только деструктор
+            storage_[segment].Swap(memory);
+            return storage_[segment].GetAddress();
+        }
+        std::destroy_n(memory.GetAddress(), Segments::SegmentSize(segment));
+        return expected;
+    }
+
+    // Продвигает size_ по созданным элементам. Каждый поток вызывает его после создания
+    // своего элемента, поэтому ни один созданный элемент не останется за пределами Size().
+    void Publish() noexcept {
+        size_t size = size_.load();
+        while (IsReady(size)) {
+            if (size_.compare_exchange_weak(size, size + 1)) {
+                ++size;
+            }
+        }
+    }
+
+    bool IsReady(size_t index) noexcept {
+        const size_t segment = Segments::SegmentOf(index);
+        const Slot* slots = segments_[segment].load(std::memory_order_acquire);
+        return slots != nullptr && slots[Segments::OffsetOf(index, segment)].ready.load();
+    }
+
+    std::atomic<size_t> reserved_ = 0;
+    std::atomic<size_t> size_ = 0;
+    std::atomic<Slot*> segments_[Segments::MAX_SEGMENTS] = {};
+    RawMemory<Slot> storage_[Segments::MAX_SEGMENTS];
+};
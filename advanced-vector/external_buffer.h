@@ -0,0 +1,131 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Аллокатор вектора, принявшего чужой буфер. Новые буферы берутся из std::allocator,
+// а принятый буфер при освобождении передаётся функции deleter, например free или munmap.
+// Если вектор вырастет, элементы переедут в новую память, а deleter будет вызван для старого буфера.
+template <typename T>
+class ExternalBufferAllocator {
+public:
+    using value_type = T;
+    using Deleter = std::function<void(T* buf, size_t capacity)>;
+    // Принятый буфер освобождает только аллокатор, знающий о нём, поэтому аллокатор следует за буфером
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ExternalBufferAllocator() noexcept = default;
+
+    ExternalBufferAllocator(T* buf, Deleter deleter)
+        : owner_(std::make_shared<Owner>(buf, std::move(deleter))) {
+    }
+
+    template <typename U>
+    ExternalBufferAllocator(const ExternalBufferAllocator<U>& /*other*/) noexcept {
+    }
+
+    // Копия вектора размещается в обычной памяти
+    ExternalBufferAllocator select_on_container_copy_construction() const noexcept {
+        return ExternalBufferAllocator();
+    }
+
+    T* allocate(size_t n) {
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        if (owner_ && buf == owner_->buffer) {
+            owner_->buffer = nullptr;
+            owner_->deleter(buf, n);
+        } else {
+            std::allocator<T>{}.deallocate(buf, n);
+        }
+    }
+
+    friend bool operator==(const ExternalBufferAllocator& lhs, const ExternalBufferAllocator& rhs) noexcept {
+        return lhs.owner_ == rhs.owner_;
+    }
+
+private:
+    struct Owner {
+        Owner(T* buffer, Deleter deleter) noexcept
+            : buffer(buffer), deleter(std::move(deleter)) {
+        }
+
+        T* buffer;
+        Deleter deleter;
+    };
+
+    std::shared_ptr<Owner> owner_;
+};
+
+template <typename T, typename Growth = DoublingGrowth<>, typename Stats = NoStats>
+using ExternalVector = Vector<T, ExternalBufferAllocator<T>, Growth, Stats>;
+
+// Создаёт вектор поверх буфера buf на capacity элементов, первые size из которых созданы,
+// без копирования элементов. Вектор освободит буфер вызовом deleter(buf, capacity).
+// Если функция бросила исключение, владение буфером не передаётся.
+template <typename T>
+ExternalVector<T> AdoptBuffer(T* buf, size_t size, size_t capacity, typename ExternalBufferAllocator<T>::Deleter deleter) {
+    ExternalVector<T> v{ExternalBufferAllocator<T>(buf, std::move(deleter))};
+    v.Adopt(buf, size, capacity);
+    return v;
+}
+
+#ifdef __linux__
+
+// Отображает файл в память и возвращает вектор его элементов без чтения файла.
+// Отображение закрытое (MAP_PRIVATE): изменения элементов видны только этому вектору
+// и никогда не попадают в файл. Неполный элемент в конце файла игнорируется.
+template <typename T>
+ExternalVector<T> MapFile(const std::filesystem::path& path) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read from a file");
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        const int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), path.string());
+    }
+    const size_t bytes = static_cast<size_t>(file_stat.st_size);
+    const size_t size = bytes / sizeof(T);
+    if (size == 0) {
+        close(fd);
+        return ExternalVector<T>();
+    }
+    void* buf = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (buf == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), path.string());
+    }
+    try {
+        return AdoptBuffer(static_cast<T*>(buf), size, size, [bytes](T* data, size_t /*capacity*/) {
+            munmap(data, bytes);
+        });
+    } catch (...) {
+        munmap(buf, bytes);
+        throw;
+    }
+}
+
+#endif  // __linux__
@@ -0,0 +1,448 @@
+#pragma once
+#include "vector.h"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+// Способ поиска в отсортированных ключах
+enum class LookupMode {
+    // Двоичный поиск без ветвлений по отсортированным ключам
+    BINARY,
+    // Поиск по копии ключей в порядке Эйтцингера (дерево поиска в массиве, уровень за уровнем):
+    // первые уровни делят кэш-линии, а следующие можно подгружать заранее. Ускоряет поиск
+    // в больших таблицах, но каждая модификация перестраивает копию за O(n), поэтому
+    // подходит для таблиц, которые в основном читают.
+    EYTZINGER,
+};
+
+namespace detail {
+
+// Индекс первого элемента отсортированного массива, не меньшего key. Длина отрезка поиска
+// зависит только от n, а выбор половины компилируется в условное перемещение.
+template <typename K, typename Compare>
+size_t BranchlessLowerBound(const K* data, size_t n, const K& key, const Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const K* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = comp(base[half], key) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<size_t>(base - data) + static_cast<size_t>(comp(*base, key));
+}
+
+// Отсортированные уникальные ключи — общая часть FlatSet и FlatMap
+template <typename K, typename Compare>
+class SortedKeys {
+public:
+    explicit SortedKeys(const Compare& comp = Compare(), LookupMode mode = LookupMode::BINARY)
+        : comp_(comp), mode_(mode) {
+        Reindex();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    const Vector<K>& Keys() const noexcept {
+        return keys_;
+    }
+
+    const Compare& KeyComp() const noexcept {
+        return comp_;
+    }
+
+    LookupMode GetLookupMode() const noexcept {
+        return mode_;
+    }
+
+    void SetLookupMode(LookupMode mode) noexcept {
+        mode_ = mode;
+        Reindex();
+    }
+
+    size_t LowerBound(const K& key) const {
+        if (index_valid_) {
+            return EytzingerLowerBound(key);
+        }
+        return BranchlessLowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    // Индекс key или Size(), если ключа нет
+    size_t IndexOf(const K& key) const {
+        const size_t index = LowerBound(key);
+        return index != keys_.Size() && !comp_(key, keys_[index]) ? index : keys_.Size();
+    }
+
+    bool Equal(const K& lhs, const K& rhs) const {
+        return !comp_(lhs, rhs) && !comp_(rhs, lhs);
+    }
+
+    // Модификаторы отключают индекс Эйтцингера; вызывающий строит его заново через Reindex,
+    // когда изменения (в том числе значений FlatMap) завершены
+    template <typename Key>
+    void InsertAt(size_t index, Key&& key) {
+        index_valid_ = false;
+        keys_.Emplace(keys_.cbegin() + index, std::forward<Key>(key));
+    }
+
+    void EraseAt(size_t index) {
+        index_valid_ = false;
+        keys_.Erase(keys_.cbegin() + index);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        eytzinger_.Clear();
+        ranks_.Clear();
+        index_valid_ = false;
+    }
+
+    void Swap(SortedKeys& other) noexcept {
+        keys_.Swap(other.keys_);
+        eytzinger_.Swap(other.eytzinger_);
+        ranks_.Swap(other.ranks_);
+        std::swap(comp_, other.comp_);
+        std::swap(mode_, other.mode_);
+        std::swap(index_valid_, other.index_valid_);
+    }
+
+    void Assign(Vector<K>&& keys) noexcept {
+        index_valid_ = false;
+        keys_ = std::move(keys);
+    }
+
+    // Строит копию ключей в порядке Эйтцингера: узел k (с единицы) имеет потомков 2k и 2k+1.
+    // ranks_[k] — индекс ключа узла k в отсортированном массиве. Индекс лишь ускоряет поиск:
+    // если построить его не удалось, поиск выполняется двоичным, поэтому исключения не выходят наружу.
+    void Reindex() noexcept {
+        index_valid_ = false;
+        if (mode_ != LookupMode::EYTZINGER) {
+            eytzinger_ = Vector<K>();
+            ranks_ = Vector<size_t>();
+            return;
+        }
+        try {
+            const size_t n = keys_.Size();
+            Vector<size_t> ranks(n + 1);
+            size_t next = 0;
+            FillRanks(ranks, 1, next);
+            // Ключи копируются сразу на места узлов, без создания по умолчанию: K может не иметь
+            // конструктора по умолчанию. Узел 0 не используется, но место под него упрощает
+            // вычисление потомков; его занимает копия корня.
+            Vector<K> eytzinger;
+            if (n != 0) {
+                eytzinger.Reserve(n + 1);
+                eytzinger.EmplaceBack(keys_[ranks[1]]);
+                for (size_t node = 1; node <= n; ++node) {
+                    eytzinger.EmplaceBack(keys_[ranks[node]]);
+                }
+            }
+            eytzinger_.Swap(eytzinger);
+            ranks_.Swap(ranks);
+            index_valid_ = true;
+        } catch (...) {
+        }
+    }
+
+private:
+    // Симметричный обход дерева узлов выдаёт ключи по возрастанию
+    void FillRanks(Vector<size_t>& ranks, size_t node, size_t& next) const noexcept {
+        if (node > keys_.Size()) {
+            return;
+        }
+        FillRanks(ranks, node * 2, next);
+        ranks[node] = next++;
+        FillRanks(ranks, node * 2 + 1, next);
+    }
+
+    size_t EytzingerLowerBound(const K& key) const {
+        const size_t n = keys_.Size();
+        if (n == 0) {
+            return 0;
+        }
+        // Потомки узла k на log2(PREFETCH_STRIDE) уровней ниже лежат подряд с индекса
+        // k * PREFETCH_STRIDE и занимают одну кэш-линию: её загрузка начинается заранее
+        constexpr size_t PREFETCH_STRIDE = std::bit_floor(std::max<size_t>(64 / sizeof(K), 1));
+        const K* nodes = eytzinger_.begin();
+        size_t k = 1;
+        while (k <= n) {
+#if defined(__GNUC__)
+            __builtin_prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(nodes)
+                                                             + k * PREFETCH_STRIDE * sizeof(K)));
+#endif
+            k = 2 * k + static_cast<size_t>(comp_(nodes[k], key));
+        }
+        // Снимаем последние повороты вправо и один влево: остаётся узел-ответ или 0
+        k >>= std::countr_one(k) + 1;
+        return k == 0 ? n : ranks_[k];
+    }
+
+    Vector<K> keys_;
+    Vector<K> eytzinger_;
+    Vector<size_t> ranks_;
+    [[no_unique_address]] Compare comp_;
+    LookupMode mode_;
+    bool index_valid_ = false;
+};
+
+}  // namespace detail
+
+// Множество уникальных ключей в отсортированном Vector. Поиск — O(log n) без ветвлений
+// или по индексу Эйтцингера, вставка и удаление одного ключа — O(n).
+template <typename K, typename Compare = std::less<K>>
+class FlatSet {
+public:
+    using const_iterator = const K*;
+
+    explicit FlatSet(const Compare& comp = Compare(), LookupMode mode = LookupMode::BINARY)
+        : keys_(comp, mode) {
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    const Vector<K>& Keys() const noexcept {
+        return keys_.Keys();
+    }
+
+    void SetLookupMode(LookupMode mode) noexcept {
+        keys_.SetLookupMode(mode);
+    }
+
+    // Индекс первого ключа, не меньшего key
+    size_t LowerBound(const K& key) const {
+        return keys_.LowerBound(key);
+    }
+
+    bool Contains(const K& key) const {
+        return keys_.IndexOf(key) != keys_.Size();
+    }
+
+    const_iterator Find(const K& key) const {
+        return begin() + keys_.IndexOf(key);
+    }
+
+    // Возвращает false, если ключ уже есть
+    bool Insert(const K& key) {
+        const size_t index = keys_.LowerBound(key);
+        if (index != keys_.Size() && keys_.Equal(keys_.Keys()[index], key)) {
+            return false;
+        }
+        keys_.InsertAt(index, key);
+        keys_.Reindex();
+        return true;
+    }
+
+    // Вливает отсортированный диапазон за один проход вместо вставки по одному ключу.
+    // Повторяющиеся ключи пропускаются. Строгая гарантия безопасности исключений.
+    template <std::input_iterator It>
+    void InsertSorted(It first, It last) {
+        const Vector<K>& old_keys = keys_.Keys();
+        Vector<K> merged;
+        if constexpr (std::forward_iterator<It>) {
+            merged.Reserve(old_keys.Size() + static_cast<size_t>(std::distance(first, last)));
+        }
+        const auto append = [this, &merged](const K& key) {
+            if (merged.Size() == 0 || !keys_.Equal(merged[merged.Size() - 1], key)) {
+                merged.PushBack(key);
+            }
+        };
+        const K* old = old_keys.begin();
+        for (; first != last; ++first) {
+            const K& key = *first;
+            assert(merged.Size() == 0 || !keys_.KeyComp()(key, merged[merged.Size() - 1]));
+            for (; old != old_keys.end() && !keys_.KeyComp()(key, *old); ++old) {
+                append(*old);
+            }
+            append(key);
+        }
+        for (; old != old_keys.end(); ++old) {
+            append(*old);
+        }
+        keys_.Assign(std::move(merged));
+        keys_.Reindex();
+    }
+
+    // Возвращает false, если ключа не было
+    bool Erase(const K& key) {
+        const size_t index = keys_.IndexOf(key);
+        if (index == keys_.Size()) {
+            return false;
+        }
+        keys_.EraseAt(index);
+        keys_.Reindex();
+        return true;
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.Keys().begin();
+    }
+
+    const_iterator end() const noexcept {
+        return keys_.Keys().end();
+    }
+
+private:
+    detail::SortedKeys<K, Compare> keys_;
+};
+
+// Отображение в виде двух параллельных векторов: отсортированных ключей и значений.
+// Поиск читает только ключи, поэтому большие значения не вытесняют ключи из кэша.
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap {
+public:
+    explicit FlatMap(const Compare& comp = Compare(), LookupMode mode = LookupMode::BINARY)
+        : keys_(comp, mode) {
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    const Vector<K>& Keys() const noexcept {
+        return keys_.Keys();
+    }
+
+    // Значения в порядке ключей. Изменять можно сами значения, но не их количество.
+    Vector<V>& Values() noexcept {
+        return values_;
+    }
+
+    const Vector<V>& Values() const noexcept {
+        return values_;
+    }
+
+    void SetLookupMode(LookupMode mode) noexcept {
+        keys_.SetLookupMode(mode);
+    }
+
+    size_t LowerBound(const K& key) const {
+        return keys_.LowerBound(key);
+    }
+
+    bool Contains(const K& key) const {
+        return keys_.IndexOf(key) != keys_.Size();
+    }
+
+    // Значение по ключу или nullptr
+    V* Find(const K& key) {
+        const size_t index = keys_.IndexOf(key);
+        return index != keys_.Size() ? &values_[index] : nullptr;
+    }
+
+    const V* Find(const K& key) const {
+        return const_cast<FlatMap&>(*this).Find(key);
+    }
+
+    const V& At(const K& key) const {
+        if (const V* value = Find(key)) {
+            return *value;
+        }
+        throw std::out_of_range("FlatMap::At: no such key");
+    }
+
+    V& operator[](const K& key) {
+        return TryEmplace(key).first;
+    }
+
+    // Вставляет значение, созданное из args, если ключа ещё нет. Возвращает значение по ключу
+    // и признак вставки.
+    template <typename... Args>
+    std::pair<V&, bool> TryEmplace(const K& key, Args&&... args) {
+        const size_t index = keys_.LowerBound(key);
+        if (index != keys_.Size() && keys_.Equal(keys_.Keys()[index], key)) {
+            return {values_[index], false};
+        }
+        values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.InsertAt(index, key);
+        } catch (...) {
+            values_.Erase(values_.cbegin() + index);
+            throw;
+        }
+        keys_.Reindex();
+        return {values_[index], true};
+    }
+
+    bool Insert(const K& key, const V& value) {
+        return TryEmplace(key, value).second;
+    }
+
+    // Вливает отсортированный по ключам диапазон пар (ключ, значение) за один проход.
+    // Для повторяющихся ключей остаётся первое значение, уже имеющееся в отображении.
+    // Строгая гарантия безопасности исключений.
+    template <std::input_iterator It>
+    void InsertSorted(It first, It last) {
+        const Vector<K>& old_keys = keys_.Keys();
+        Vector<K> merged_keys;
+        Vector<V> merged_values;
+        if constexpr (std::forward_iterator<It>) {
+            const size_t capacity = old_keys.Size() + static_cast<size_t>(std::distance(first, last));
+            merged_keys.Reserve(capacity);
+            merged_values.Reserve(capacity);
+        }
+        const auto append = [this, &merged_keys, &merged_values](const K& key, const V& value) {
+            if (merged_keys.Size() == 0 || !keys_.Equal(merged_keys[merged_keys.Size() - 1], key)) {
+                merged_keys.PushBack(key);
+                merged_values.PushBack(value);
+            }
+        };
+        size_t old = 0;
+        for (; first != last; ++first) {
+            const auto& [key, value] = *first;
+            assert(merged_keys.Size() == 0 || !keys_.KeyComp()(key, merged_keys[merged_keys.Size() - 1]));
+            for (; old != old_keys.Size() && !keys_.KeyComp()(key, old_keys[old]); ++old) {
+                append(old_keys[old], values_[old]);
+            }
+            append(key, value);
+        }
+        for (; old != old_keys.Size(); ++old) {
+            append(old_keys[old], values_[old]);
+        }
+        values_.Swap(merged_values);
+        keys_.Assign(std::move(merged_keys));
+        keys_.Reindex();
+    }
+
+    bool Erase(const K& key) {
+        const size_t index = keys_.IndexOf(key);
+        if (index == keys_.Size()) {
+            return false;
+        }
+        keys_.EraseAt(index);
+        values_.Erase(values_.cbegin() + index);
+        keys_.Reindex();
+        return true;
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+private:
+    detail::SortedKeys<K, Compare> keys_;
+    Vector<V> values_;
+};
@@ -0,0 +1,472 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Вектор с запасом памяти с обоих концов и подвижным промежутком внутри одного буфера RawMemory:
+//   [запас спереди][элементы до промежутка][промежуток][элементы после промежутка][запас сзади]
+// PushFront и PushBack выполняются за амортизированное O(1), а вставка и удаление в позиции
+// промежутка — за O(1). Вставка в другую позицию сначала переносит к ней промежуток, сдвигая
+// только элементы между старой и новой позициями, поэтому серии правок рядом с курсором дёшевы.
+// Элементы непрерывны не всегда: Data() собирает их вместе, переставляя меньшую из частей.
+// Когда нужной области не хватает места, буфер выделяется заново вдвое больше числа элементов,
+// и половина свободного места отдаётся этой области. Перевыделение даёт строгую гарантию
+// безопасности исключений, как в Vector.
+template <typename T>
+class GapVector {
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const GapVector, GapVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner), index_(index) {
+        }
+
+        operator BasicIterator<true>() const noexcept
+            requires(!IsConst)
+        {
+            return BasicIterator<true>(owner_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend std::strong_ordering operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    // Область буфера, которой не хватило места при вставке
+    enum class Region { FRONT, GAP, BACK };
+
+    static constexpr size_t MIN_CAPACITY = 8;
+
+    // Сдвиг элементов при переносе промежутка не бросает исключений
+    static constexpr bool NOTHROW_SHIFT = IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>;
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    GapVector() noexcept = default;
+
+    explicit GapVector(size_t size)
+        : data_(size) {
+        detail::UninitializedValueConstructN(data_.GetAddress(), size);
+        gap_begin_ = gap_end_ = back_ = size;
+    }
+
+    GapVector(const GapVector& other)
+        : data_(other.Size()) {
+        other.TransferRange(0, other.Size(), data_.GetAddress(), [](const T* from, size_t n, T* to) {
+            detail::UninitializedCopyN(from, n, to);
+        });
+        gap_begin_ = gap_end_ = back_ = other.Size();
+    }
+
+    GapVector(GapVector&& other) noexcept {
+        Swap(other);
+    }
+
+    GapVector& operator=(const GapVector& rhs) {
+        if (this != &rhs) {
+            GapVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    GapVector& operator=(GapVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~GapVector() {
+        DestroyElements();
+    }
+
+    void Swap(GapVector& other) noexcept {
+        data_.Swap(other.data_);
+        std::swap(front_, other.front_);
+        std::swap(gap_begin_, other.gap_begin_);
+        std::swap(gap_end_, other.gap_end_);
+        std::swap(back_, other.back_);
+    }
+
+    size_t Size() const noexcept {
+        return FrontSize() + (back_ - gap_end_);
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // Индекс первого элемента после промежутка: вставка по этому индексу ничего не сдвигает
+    size_t GapPosition() const noexcept {
+        return FrontSize();
+    }
+
+    // Уничтожает элементы и делит освободившийся буфер поровну между запасами спереди и сзади
+    void Clear() noexcept {
+        DestroyElements();
+        front_ = gap_begin_ = gap_end_ = back_ = Capacity() / 2;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<GapVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return data_[index < FrontSize() ? front_ + index : gap_end_ + (index - FrontSize())];
+    }
+
+    // Переносит промежуток так, чтобы перед ним оказалось index элементов. Сдвигаются только
+    // элементы между старой и новой позициями промежутка; если промежуток пуст, не сдвигается ничего.
+    // Порядок элементов не меняется, даже если перемещение элемента бросило исключение.
+    void MoveGap(size_t index) noexcept(NOTHROW_SHIFT) {
+        assert(index <= Size());
+        const size_t front_size = FrontSize();
+        if (gap_begin_ == gap_end_) {
+            gap_begin_ = gap_end_ = front_ + index;
+        } else if (index < front_size) {
+            const size_t count = front_size - index;
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                detail::RelocateOverlapping(data_ + (gap_begin_ - count), count, data_ + (gap_end_ - count));
+                gap_begin_ -= count;
+                gap_end_ -= count;
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    detail::UninitializedMoveOrCopyN(data_ + (gap_begin_ - 1), 1, data_ + (gap_end_ - 1));
+                    std::destroy_at(data_ + (gap_begin_ - 1));
+                    --gap_begin_;
+                    --gap_end_;
+                }
+            }
+        } else {
+            const size_t count = index - front_size;
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                detail::RelocateOverlapping(data_ + gap_end_, count, data_ + gap_begin_);
+                gap_begin_ += count;
+                gap_end_ += count;
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    detail::UninitializedMoveOrCopyN(data_ + gap_end_, 1, data_ + gap_begin_);
+                    std::destroy_at(data_ + gap_end_);
+                    ++gap_begin_;
+                    ++gap_end_;
+                }
+            }
+        }
+    }
+
+    // Делает элементы непрерывными и возвращает указатель на первый из них. Промежуток
+    // переносится к ближайшему концу, поэтому переставляется не больше половины элементов.
+    T* Data() noexcept(NOTHROW_SHIFT) {
+        if (gap_begin_ != gap_end_) {
+            MoveGap(FrontSize() * 2 <= Size() ? 0 : Size());
+        }
+        return data_ + (FrontSize() != 0 ? front_ : gap_end_);
+    }
+
+    void PushFront(const T& value) {
+        EmplaceFront(value);
+    }
+
+    void PushFront(T&& value) {
+        EmplaceFront(std::move(value));
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceFront(Args&&... args) {
+        return EmplaceAt(0, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return EmplaceAt(Size(), std::forward<Args>(args)...);
+    }
+
+    // Освобождённое место остаётся в запасе спереди или в промежутке
+    void PopFront() noexcept {
+        assert(Size() > 0);
+        if (FrontSize() != 0) {
+            std::destroy_at(data_ + front_++);
+        } else {
+            std::destroy_at(data_ + gap_end_++);
+        }
+    }
+
+    void PopBack() noexcept {
+        assert(Size() > 0);
+        if (back_ != gap_end_) {
+            std::destroy_at(data_ + --back_);
+        } else {
+            std::destroy_at(data_ + --gap_begin_);
+        }
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos - cbegin();
+        EmplaceAt(index, std::forward<Args>(args)...);
+        return iterator(this, index);
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Переносит промежуток к удаляемому элементу, и его место присоединяется к промежутку
+    iterator Erase(const_iterator pos) noexcept(NOTHROW_SHIFT) {
+        assert(pos >= cbegin() && pos < cend());
+        const size_t index = pos - cbegin();
+        if (index == 0) {
+            PopFront();
+        } else if (index + 1 == Size()) {
+            PopBack();
+        } else if (index >= FrontSize()) {
+            MoveGap(index);
+            std::destroy_at(data_ + gap_end_++);
+        } else {
+            MoveGap(index + 1);
+            std::destroy_at(data_ + --gap_begin_);
+        }
+        return iterator(this, index);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, Size());
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, Size());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    size_t FrontSize() const noexcept {
+        return gap_begin_ - front_;
+    }
+
+    // Создаёт элемент с индексом index. Аргументы могут ссылаться на элементы самого вектора.
+    template <typename... Args>
+    T& EmplaceAt(size_t index, Args&&... args) {
+        const size_t size = Size();
+        assert(index <= size);
+        if (index == size && back_ != Capacity()) {
+            return *std::construct_at(data_ + back_++, std::forward<Args>(args)...);
+        }
+        if (index == 0 && front_ != 0) {
+            T* place = std::construct_at(data_ + (front_ - 1), std::forward<Args>(args)...);
+            --front_;
+            return *place;
+        }
+        if (gap_begin_ != gap_end_) {
+            // Вставка перед первым элементом без запаса спереди занимает конец промежутка
+            if (index == 0 && FrontSize() == 0) {
+                T* place = std::construct_at(data_ + (gap_end_ - 1), std::forward<Args>(args)...);
+                --gap_end_;
+                return *place;
+            }
+            if (index == FrontSize()) {
+                return *std::construct_at(data_ + gap_begin_++, std::forward<Args>(args)...);
+            }
+            // Перенос промежутка сдвигает элементы, на которые могут ссылаться аргументы
+            T temp(std::forward<Args>(args)...);
+            MoveGap(index);
+            return *std::construct_at(data_ + gap_begin_++, std::move(temp));
+        }
+        const Region region = index == size ? Region::BACK : index == 0 ? Region::FRONT : Region::GAP;
+        return EmplaceWithRealloc(index, region, std::forward<Args>(args)...);
+    }
+
+    // Новый элемент создаётся в новом буфере до переноса остальных, поэтому аргументы
+    // могут ссылаться на элементы вектора
+    template <typename... Args>
+    T& EmplaceWithRealloc(size_t index, Region region, Args&&... args) {
+        const size_t size = Size();
+        RawMemory<T> new_data(std::max((size + 1) * 2, MIN_CAPACITY));
+        const size_t spare = new_data.Capacity() - size - 1;
+        const size_t other_share = spare / 4;
+        const size_t front_spare = region == Region::FRONT ? spare - 2 * other_share : other_share;
+        const size_t gap = region == Region::GAP ? spare - 2 * other_share : other_share;
+
+        const size_t new_gap_begin = front_spare + index + 1;
+        T* place = std::construct_at(new_data + (new_gap_begin - 1), std::forward<Args>(args)...);
+        try {
+            RelocateTo(new_data, index, front_spare, new_gap_begin + gap);
+        } catch (...) {
+            std::destroy_at(place);
+            throw;
+        }
+        data_.Swap(new_data);
+        front_ = front_spare;
+        gap_begin_ = new_gap_begin;
+        gap_end_ = new_gap_begin + gap;
+        back_ = gap_end_ + (size - index);
+        return *place;
+    }
+
+    // Переносит элементы [0, index) в new_data начиная с front, а [index, Size()) — начиная с back.
+    // Если перенос бросил исключение, исходные элементы не изменяются.
+    void RelocateTo(RawMemory<T>& new_data, size_t index, size_t front, size_t back) {
+        const auto move_or_copy = [](T* from, size_t n, T* to) {
+            detail::UninitializedMoveOrCopyN(from, n, to);
+        };
+        TransferRange(0, index, new_data + front, move_or_copy);
+        try {
+            TransferRange(index, Size(), new_data + back, move_or_copy);
+        } catch (...) {
+            std::destroy_n(new_data + front, index);
+            throw;
+        }
+        DestroyElements();
+    }
+
+    // Вызывает transfer(from, n, to) для частей отрезка [first, last) до и после промежутка,
+    // создавая элементы подряд начиная с to. Если transfer бросил исключение, созданные
+    // элементы уничтожаются.
+    template <typename Transfer>
+    void TransferRange(size_t first, size_t last, T* to, Transfer transfer) const {
+        T* data = const_cast<T*>(data_.GetAddress());
+        const size_t front_size = FrontSize();
+        size_t done = 0;
+        if (first < front_size) {
+            done = std::min(last, front_size) - first;
+            transfer(data + front_ + first, done, to);
+        }
+        if (last > front_size) {
+            const size_t from = std::max(first, front_size);
+            try {
+                transfer(data + gap_end_ + (from - front_size), last - from, to + done);
+            } catch (...) {
+                std::destroy_n(to, done);
+                throw;
+            }
+        }
+    }
+
+    void DestroyElements() noexcept {
+        std::destroy_n(data_ + front_, FrontSize());
+        std::destroy_n(data_ + gap_end_, back_ - gap_end_);
+    }
+
+    RawMemory<T> data_;
+    size_t front_ = 0;
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+    size_t back_ = 0;
+};
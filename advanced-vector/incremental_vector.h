@@ -0,0 +1,344 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Вектор, растущий без переноса всех элементов за один вызов. Когда буфер заполнен,
+// выделяется буфер вдвое большей ёмкости, новые элементы создаются сразу в нём, а старые
+// переносятся в него отрезками не больше MigrationChunkBytes за каждый следующий EmplaceBack.
+// Пока перенос не закончен, элемент i находится в старом буфере, если ещё не перенесён, иначе
+// в новом, и индексация выбирает буфер одним сравнением. Новый буфер вмещает не меньше
+// элементов, чем осталось перенести, поэтому перенос заканчивается до его заполнения.
+// Migrate позволяет продвинуть перенос в удобный момент, например между запросами.
+// Перенос нельзя откатить посреди добавления, поэтому перемещение T не должно бросать исключений.
+template <typename T, typename Alloc = std::allocator<T>, size_t MigrationChunkBytes = (size_t{64} << 10)>
+class IncrementalVector {
+    static_assert(IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>,
+                  "Elements are migrated by moves that must not throw");
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const IncrementalVector, IncrementalVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner), index_(index) {
+        }
+
+        operator BasicIterator<true>() const noexcept
+            requires(!IsConst)
+        {
+            return BasicIterator<true>(owner_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend std::strong_ordering operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static constexpr size_t CHUNK_SIZE = std::max<size_t>(MigrationChunkBytes / sizeof(T), 1);
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    IncrementalVector() noexcept(noexcept(Alloc())) = default;
+
+    explicit IncrementalVector(const Alloc& alloc) noexcept
+        : data_(alloc), old_(alloc) {
+    }
+
+    explicit IncrementalVector(size_t size, const Alloc& alloc = Alloc())
+        : data_(size, alloc), old_(alloc) {
+        detail::UninitializedValueConstructN(data_.GetAddress(), size);
+        size_ = size;
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+        , old_(data_.GetAllocator()) {
+        T* to = data_.GetAddress();
+        const T* migrated = other.data_.GetAddress();
+        detail::UninitializedCopyN(migrated, other.migrated_, to);
+        try {
+            detail::UninitializedCopyN(other.old_.GetAddress() + other.migrated_, other.old_size_ - other.migrated_,
+                                       to + other.migrated_);
+            try {
+                detail::UninitializedCopyN(migrated + other.old_size_, other.size_ - other.old_size_,
+                                           to + other.old_size_);
+            } catch (...) {
+                std::destroy_n(to + other.migrated_, other.old_size_ - other.migrated_);
+                throw;
+            }
+        } catch (...) {
+            std::destroy_n(to, other.migrated_);
+            throw;
+        }
+        size_ = other.size_;
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_(std::move(other.old_))
+        , size_(std::exchange(other.size_, 0))
+        , old_size_(std::exchange(other.old_size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0)) {
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            IncrementalVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        DestroyElements();
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(migrated_, other.migrated_);
+    }
+
+    Alloc GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // Ёмкость нового буфера: до неё добавление не выделяет память
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    bool IsMigrating() const noexcept {
+        return migrated_ != old_size_;
+    }
+
+    // Переносит не больше max_count элементов из старого буфера и возвращает,
+    // сколько ещё осталось перенести. Старый буфер освобождается, когда перенос закончен.
+    size_t Migrate(size_t max_count) noexcept {
+        const size_t count = std::min(max_count, old_size_ - migrated_);
+        detail::UninitializedRelocateN(old_.GetAddress() + migrated_, count, data_.GetAddress() + migrated_);
+        migrated_ += count;
+        if (migrated_ == old_size_ && old_.Capacity() != 0) {
+            RawMemory<T, Alloc>(old_.GetAllocator()).Swap(old_);
+            old_size_ = migrated_ = 0;
+        }
+        return old_size_ - migrated_;
+    }
+
+    void FinishMigration() noexcept {
+        Migrate(old_size_ - migrated_);
+    }
+
+    // Сначала заканчивает перенос, а затем переносит все элементы за один вызов, как Vector
+    void Reserve(size_t new_capacity) {
+        FinishMigration();
+        if (new_capacity > data_.Capacity()) {
+            RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+            detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+            data_.Swap(new_data);
+        }
+    }
+
+    // Уничтожает элементы; старый буфер освобождается, новый остаётся
+    void Clear() noexcept {
+        DestroyElements();
+        RawMemory<T, Alloc>(old_.GetAllocator()).Swap(old_);
+        size_ = old_size_ = migrated_ = 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    // Элементы [migrated_, old_size_) ещё в старом буфере; без переноса отрезок пуст
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index - migrated_ < old_size_ - migrated_ ? old_[index] : data_[index];
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Выделяет память, но не переносит больше CHUNK_SIZE элементов за вызов. Новый элемент
+    // создаётся до переноса, поэтому аргументы могут ссылаться на элементы вектора.
+    // Если конструктор бросил исключение, вектор не изменяется (новый буфер может остаться выделенным).
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == data_.Capacity()) {
+            StartMigration();
+        }
+        T* place = std::construct_at(data_.GetAddress() + size_, std::forward<Args>(args)...);
+        ++size_;
+        Migrate(CHUNK_SIZE);
+        return *place;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(&(*this)[size_ - 1]);
+        --size_;
+        // Удалённый элемент мог быть ещё не перенесён
+        if (size_ < old_size_) {
+            old_size_ = size_;
+            migrated_ = std::min(migrated_, old_size_);
+            Migrate(0);
+        }
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Текущий буфер становится старым. Переноса предыдущего роста здесь уже нет: новый буфер
+    // вдвое больше, и каждое из заполнивших его добавлений переносило хотя бы один элемент.
+    void StartMigration() {
+        assert(!IsMigrating());
+        RawMemory<T, Alloc> new_data(size_ == 0 ? 1 : size_ * 2, data_.GetAllocator());
+        data_.Swap(new_data);
+        old_.Swap(new_data);
+        old_size_ = size_;
+        migrated_ = 0;
+    }
+
+    void DestroyElements() noexcept {
+        std::destroy_n(data_.GetAddress(), migrated_);
+        std::destroy_n(old_.GetAddress() + migrated_, old_size_ - migrated_);
+        std::destroy_n(data_.GetAddress() + old_size_, size_ - old_size_);
+    }
+
+    RawMemory<T, Alloc> data_;
+    RawMemory<T, Alloc> old_;
+    size_t size_ = 0;
+    // Элементы [0, old_size_) были в старом буфере, из них [0, migrated_) уже перенесены
+    size_t old_size_ = 0;
+    size_t migrated_ = 0;
+};
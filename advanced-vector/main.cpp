@@ -1,10 +1,41 @@
 #include "vector.h"
+#include "allocators.h"
+#include "small_vector.h"
+#include "vector_algorithms.h"
+#include "concurrent_vector.h"
+#include "segmented_vector.h"
+#include "external_buffer.h"
+#include "persistent_vector.h"
+#include "flat_map.h"
+#include "soa_vector.h"
+#include "static_vector.h"
+#include "vector_io.h"
+#include "parallel_algorithms.h"
+#include "gap_vector.h"
+#include "incremental_vector.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <set>
+#include <numeric>
+#include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace {
 
 // "Магическое" число, используемое для отслеживания живости объекта
@@ -116,8 +147,154 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+// Аллокатор с состоянием: считает выделения и сравнивается по идентификатору
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit CountingAllocator(int id = 0) noexcept
+        : id(id) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : id(other.id) {
+    }
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ++num_deallocations;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    friend bool operator==(const CountingAllocator& lhs, const CountingAllocator& rhs) noexcept {
+        return lhs.id == rhs.id;
+    }
+
+    static void ResetCounters() {
+        num_allocations = 0;
+        num_deallocations = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_allocations = 0;
+    static inline int num_deallocations = 0;
+};
+
+// Нетривиальный тип, объявленный тривиально перемещаемым через специализацию IsTriviallyRelocatable
+struct RelocatableObj {
+    RelocatableObj() = default;
+
+    explicit RelocatableObj(int id)
+        : id(id) {
+    }
+
+    RelocatableObj(const RelocatableObj& other)
+        : id(other.id) {
+        ++num_copied;
+    }
+
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : id(other.id) {
+        ++num_moved;
+    }
+
+    RelocatableObj& operator=(const RelocatableObj& other) = default;
+    RelocatableObj& operator=(RelocatableObj&& other) = default;
+
+    ~RelocatableObj() {
+        ++num_destroyed;
+    }
+
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+// Копируемый нетривиальный тип с noexcept-перемещением; для него задана политика FORBID
+struct NothrowMoveObj {
+    NothrowMoveObj() = default;
+
+    explicit NothrowMoveObj(int id)
+        : id(id) {
+    }
+
+    NothrowMoveObj(const NothrowMoveObj& other) = default;
+    NothrowMoveObj(NothrowMoveObj&& other) noexcept = default;
+    NothrowMoveObj& operator=(const NothrowMoveObj& other) = default;
+    NothrowMoveObj& operator=(NothrowMoveObj&& other) noexcept = default;
+
+    std::string name;
+    int id = 0;
+};
+
+// Тип для параллельных операций: счётчики атомарные. Перемещение может бросать,
+// поэтому при росте вектор копирует элементы
+struct ParallelObj {
+    ParallelObj() {
+        if (construction_throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    ParallelObj(const ParallelObj& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    ParallelObj(ParallelObj&& other) noexcept(false)
+        : ParallelObj(static_cast<const ParallelObj&>(other)) {
+    }
+
+    ParallelObj& operator=(const ParallelObj& other) = default;
+
+    ~ParallelObj() {
+        --num_alive;
+    }
+
+    static void ResetCounters() {
+        construction_throw_countdown = 0;
+        num_alive = 0;
+    }
+
+    bool throw_on_copy = false;
+    int id = 0;
+
+    static inline std::atomic<int> construction_throw_countdown = 0;
+    static inline std::atomic<int> num_alive = 0;
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {
+};
+
+// Для типов с noexcept-перемещением FORBID ничего не запрещает
+template <>
+struct CopyFallbackPolicy<NothrowMoveObj> : std::integral_constant<CopyFallback, CopyFallback::FORBID> {
+};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -558,84 +735,1884 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    using Alloc = CountingAllocator<Obj>;
+    {
+        Obj::ResetCounters();
+        Alloc::ResetCounters();
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc{1});
+            v.PushBack(Obj{ID});
+            assert(v.GetAllocator().id == 1);
+            assert(Alloc::num_allocations == 2);
+
+            const Vector<Obj, Alloc> v_copy(v);
+            assert(v_copy.GetAllocator().id == 1);
+            assert(v_copy[SIZE].id == ID);
+        }
+        assert(Alloc::num_allocations == Alloc::num_deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        Obj::ResetCounters();
+        Alloc::ResetCounters();
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc{1});
+            v[0].id = ID;
+            Vector<Obj, Alloc> other(Alloc{2});
+            // propagate_on_container_move_assignment == false и аллокаторы не равны:
+            // элементы перемещаются в память аллокатора other
+            other = std::move(v);
+            assert(other.GetAllocator().id == 2);
+            assert(other.Size() == SIZE);
+            assert(other[0].id == ID);
+            assert(Obj::num_moved == static_cast<int>(SIZE));
+
+            // propagate_on_container_copy_assignment == true: аллокатор копируется вместе с элементами
+            Vector<Obj, Alloc> copy(Alloc{3});
+            copy = other;
+            assert(copy.GetAllocator().id == 2);
+            assert(copy[0].id == ID);
+        }
+        assert(Alloc::num_allocations == Alloc::num_deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        std::byte buffer[1024];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::Vector<int> v(&arena);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == 100);
+        assert(v[99] == 99);
+        assert(v.GetAllocator().resource() == &arena);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+}
+
+void Test8() {
+    const size_t SIZE = 100;
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
         }
-        return *this;
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.cbegin() + SIZE / 2, -1);
+        assert(v.Size() == SIZE + 1);
+        assert(v[SIZE / 2].id == -1);
+        assert(v[SIZE / 2 + 1].id == static_cast<int>(SIZE / 2));
+        // Рост буфера переносит элементы побайтово, без перемещений и деструкторов
+        assert(RelocatableObj::num_copied == 0);
+        assert(RelocatableObj::num_destroyed == RelocatableObj::num_moved);
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Insert(v.cbegin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1);
+        assert(*v[SIZE] == static_cast<int>(SIZE) - 1);
+    }
+}
+
+void Test9() {
+    {
+        // Буфер переходит порог MMAP_THRESHOLD и дальше растёт через mremap
+        const size_t SIZE = (MallocAllocator<uint64_t>::MMAP_THRESHOLD / sizeof(uint64_t)) * 3;
+        Vector<uint64_t, MallocAllocator<uint64_t>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; i += 4096) {
+            assert(v[i] == i);
+        }
+        v.Reserve(SIZE * 3);
+        assert(v.Capacity() == SIZE * 3);
+        assert(v[SIZE - 1] == SIZE - 1);
     }
-    ~C() {
-        ++dtor;
+    {
+        Vector<int, MallocAllocator<int>> v(10);
+        v[5] = 5;
+        assert(v.Size() == v.Capacity());
+        // Аргумент ссылается на элемент вектора, буфер которого переезжает
+        v.Insert(v.cbegin() + 1, v[5]);
+        v.PushBack(v[0]);
+        assert(v.Size() == 12);
+        assert(v[1] == 5);
+        assert(v[6] == 5);
+        assert(v[11] == 0);
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+template <typename Growth>
+std::vector<size_t> CapacityHistory(size_t size) {
+    std::vector<size_t> capacities;
+    Vector<int, std::allocator<int>, Growth> v;
+    for (size_t i = 0; i < size; ++i) {
+        v.PushBack(static_cast<int>(i));
+        if (capacities.empty() || capacities.back() != v.Capacity()) {
+            capacities.push_back(v.Capacity());
+        }
     }
+    return capacities;
+}
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
-};
+void Test10() {
+    assert((CapacityHistory<DoublingGrowth<>>(9) == std::vector<size_t>{1, 2, 4, 8, 16}));
+    assert((CapacityHistory<DoublingGrowth<8>>(9) == std::vector<size_t>{8, 16}));
+    assert((CapacityHistory<OneAndHalfGrowth<>>(20) == std::vector<size_t>{4, 6, 9, 13, 19, 28}));
+    // 64 байта — 16 элементов int, дальше ёмкость в байтах остаётся степенью двойки
+    assert((CapacityHistory<PowerOfTwoBytesGrowth<>>(40) == std::vector<size_t>{16, 32, 64}));
+    // Порог 64 байта, шаг 32 байта (8 элементов int)
+    assert((CapacityHistory<LinearAfterThresholdGrowth<64, 32, 4>>(40)
+            == std::vector<size_t>{4, 8, 16, 24, 32, 40}));
+    {
+        Vector<Obj, std::allocator<Obj>, OneAndHalfGrowth<>> v(10);
+        v.Emplace(v.cbegin(), 1);
+        assert(v.Capacity() == 15);
+        assert(v[0].id == 1);
+    }
+}
+
+void Test11() {
+    const size_t N = 4;
+    const int ID = 42;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v;
+        assert(v.Capacity() == N);
+        for (size_t i = 0; i < N; ++i) {
+            v.EmplaceBack(static_cast<int>(i), "Ivan"s);
+        }
+        assert(v.IsInline());
+        assert(reinterpret_cast<const std::byte*>(&v[0]) >= reinterpret_cast<const std::byte*>(&v));
+        assert(reinterpret_cast<const std::byte*>(&v[N - 1]) < reinterpret_cast<const std::byte*>(&v + 1));
+        assert(Obj::num_moved == 0);
+
+        v.EmplaceBack(ID);
+        assert(!v.IsInline());
+        assert(v.Capacity() == N * 2);
+        assert(v.Size() == N + 1);
+        assert(v[N].id == ID);
+        assert(Obj::num_moved == static_cast<int>(N));
+        assert(Obj::num_copied == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Строгая гарантия при копировании, если перемещение может бросить исключение
+        struct ThrowingMove : Obj {
+            ThrowingMove() = default;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&& other) noexcept(false)
+                : Obj(static_cast<const Obj&>(other)) {
+            }
+        };
+        Obj::ResetCounters();
+        SmallVector<ThrowingMove, N> v(N);
+        v[N - 1].throw_on_copy = true;
+        try {
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.IsInline());
+        assert(v.Size() == N);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<TestObj, 1> v(1);
+        v.PushBack(v[0]);
+        v.Insert(v.cbegin(), std::move(v[1]));
+        v.Emplace(v.cbegin() + 1, v[0]);
+        assert(v.Size() == 4);
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v(N - 1);
+        v[1].id = ID;
+        v.Emplace(v.cbegin() + 1, 1);
+        assert(v.Size() == N);
+        assert(v[1].id == 1);
+        assert(v[2].id == ID);
+        v.Erase(v.cbegin());
+        assert(v[0].id == 1);
+        v.Resize(N * 3);
+        assert(!v.IsInline());
+        v.Resize(1);
+        assert(v.Size() == 1);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<std::string, N> inline_v;
+        inline_v.PushBack("inline"s);
+        SmallVector<std::string, N> heap_v;
+        for (size_t i = 0; i < N * 2; ++i) {
+            heap_v.PushBack(std::to_string(i));
+        }
+        inline_v.Swap(heap_v);
+        assert(inline_v.Size() == N * 2 && !inline_v.IsInline());
+        assert(heap_v.Size() == 1 && heap_v[0] == "inline"s);
+
+        SmallVector<std::string, N> moved(std::move(heap_v));
+        assert(moved[0] == "inline"s);
+        assert(heap_v.Size() == 0);
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+        heap_v = inline_v;
+        assert(heap_v.Size() == N * 2);
+        assert(heap_v[N] == std::to_string(N));
+        heap_v = moved;
+        assert(heap_v.Size() == 1 && heap_v[0] == "inline"s);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+void Test12() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        const std::list<int> source{1, 2, 3};
+        Vector<int> v(source.begin(), source.end());
+        assert(v.Size() == 3 && v.Capacity() == 3);
+        assert(v[0] == 1 && v[2] == 3);
+
+        std::istringstream input("4 5 6");
+        Vector<int> from_stream(std::istream_iterator<int>(input), std::istream_iterator<int>{});
+        assert(from_stream.Size() == 3 && from_stream[2] == 6);
+
+        v.Insert(v.cbegin() + 1, from_stream.begin(), from_stream.end());
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 4, 5, 6, 2, 3}));
+        v.Insert(v.cend(), 2, 7);
+        v.Append(std::span<const int>(from_stream.begin(), 2));
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 4, 5, 6, 2, 3, 7, 7, 4, 5}));
+        v.Insert(v.cbegin(), 3, v[1]);
+        assert(v[0] == 4 && v[2] == 4 && v[3] == 1 && v.Size() == 13);
+
+        std::istringstream more("8 9");
+        auto pos = v.Insert(v.cbegin() + 1, std::istream_iterator<int>(more), std::istream_iterator<int>{});
+        assert(pos == v.begin() + 1);
+        assert(v[0] == 4 && v[1] == 8 && v[2] == 9 && v[3] == 4);
+    }
+    {
+        // Одна реаллокация и один перенос каждого старого элемента
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        std::vector<Obj> batch(SIZE * 3, Obj{ID});
+        const int moved_before = Obj::num_moved;
+        auto pos = v.Insert(v.cbegin() + 2, batch.begin(), batch.end());
+        assert(pos == v.begin() + 2);
+        assert(v.Size() == SIZE * 4);
+        assert(Obj::num_moved - moved_before == static_cast<int>(SIZE));
+        assert(v[2].id == ID && v[SIZE * 3 + 1].id == ID && v[SIZE * 3 + 2].id == 0);
+    }
+    {
+        // Вставка без реаллокации: короткий и длинный хвост
+        for (size_t index : {SIZE - 1, size_t{1}}) {
+            Obj::ResetCounters();
+            Vector<Obj> v(SIZE);
+            v.Reserve(SIZE * 2);
+            v[index].id = ID;
+            v.Insert(v.cbegin() + index, 3, Obj{1});
+            assert(v.Size() == SIZE + 3);
+            assert(v[index].id == 1 && v[index + 2].id == 1 && v[index + 3].id == ID);
+            assert(Obj::num_copied + Obj::num_assigned == 3);
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 3));
         }
-        Dump();
-    } catch (...) {
     }
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test13() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(pos == v.begin() + 2);
+        assert(v.Size() == SIZE - 3);
+        assert(v[2].id == 5 && v[SIZE - 4].id == static_cast<int>(SIZE) - 1);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE) - 5);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE) - 3);
+
+        assert(EraseIf(v, [](const Obj& obj) {
+                   return obj.id % 2 == 1;
+               }) == 4);
+        assert(v.Size() == 3);
+        assert(v[0].id == 0 && v[1].id == 6 && v[2].id == 8);
+        assert(Obj::GetAliveObjectCount() == 3);
+        assert(v.Erase(v.cbegin(), v.cbegin()) == v.begin());
+        v.Erase(v.cbegin(), v.cend());
+        assert(v.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        v.Reserve(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(EraseIf(v, [](const RelocatableObj& obj) {
+                   return obj.id % 3 == 0;
+               }) == 4);
+        assert(v.Size() == SIZE - 4);
+        assert(v[0].id == 1 && v[1].id == 2 && v[2].id == 4 && v[SIZE - 5].id == 8);
+        // Удалённые элементы уничтожены, оставшиеся перенесены без перемещений
+        assert(RelocatableObj::num_destroyed == 4);
+        assert(RelocatableObj::num_moved == 0);
+
+        try {
+            EraseIf(v, [](const RelocatableObj& obj) {
+                if (obj.id == 5) {
+                    throw std::runtime_error("Oops");
+                }
+                return obj.id == 2;
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE - 5);
+        assert(v[0].id == 1 && v[1].id == 4 && v[2].id == 5 && v[SIZE - 6].id == 8);
+
+        v.Erase(v.cbegin());
+        assert(v[0].id == 4);
+        assert(RelocatableObj::num_destroyed == 6);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, DEFAULT_INIT);
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE * 2));
+        v.ResizeDefaultInit(SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<char> buffer(4, DEFAULT_INIT);
+        assert(buffer.Size() == 4);
+        std::istringstream input("payload");
+        buffer.ResizeAndOverwrite(SIZE, [&input](char* data, size_t n) {
+            input.read(data, static_cast<std::streamsize>(n));
+            return static_cast<size_t>(input.gcount());
+        });
+        assert(buffer.Size() == 7);
+        assert(std::string(buffer.begin(), buffer.end()) == "payload");
+        assert(buffer.Capacity() >= SIZE);
+
+        // Уже записанные данные сохраняются
+        buffer.ResizeAndOverwrite(3, [](char* /*data*/, size_t n) {
+            return n;
+        });
+        assert(std::string(buffer.begin(), buffer.end()) == "pay");
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 4);
+        assert(v.WastedBytes() == SIZE * 3 * sizeof(Obj));
+        assert(!v.ShrinkIfWasted(4.0));
+        assert(v.ShrinkIfWasted(2.0));
+        assert(v.Capacity() == SIZE);
+        assert(v.AllocatedBytes() == SIZE * sizeof(Obj));
+        assert(Obj::num_moved == static_cast<int>(SIZE * 2));
+        assert(Obj::num_copied == 0);
+
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        assert(v.begin() == nullptr);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v[SIZE / 2] = 42;
+        v.Reserve(SIZE * 10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE);
+        assert(v[SIZE / 2] == 42);
+    }
+}
+
+void Test16() {
+    const size_t SIZE = 16;
+    // Отключённая статистика не занимает места
+    static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+    {
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth<>, CountingStats> v;
+        for (size_t i = 0; i < SIZE + 1; ++i) {
+            v.EmplaceBack();
+        }
+        const CountingStats& stats = v.GetStats();
+        // Ёмкости 1, 2, 4, 8, 16, 32
+        assert(stats.allocations == 6);
+        assert(stats.allocated_bytes == 63 * sizeof(Obj));
+        assert(stats.reallocations == 5);
+        assert(stats.relocated_by_move == 1 + 2 + 4 + 8 + 16);
+        assert(stats.relocated_by_copy == 0);
+
+        v.ResetStats();
+        v.Reserve(SIZE * 4);
+        v.Insert(v.cbegin(), SIZE * 4, Obj{});
+        assert(v.GetStats().allocations == 2);
+        assert(v.GetStats().relocated_by_move == (SIZE + 1) * 2);
+    }
+    {
+        struct ThrowingMove {
+            ThrowingMove() = default;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&&) noexcept(false) {
+            }
+            std::string value;
+        };
+        Vector<ThrowingMove, std::allocator<ThrowingMove>, DoublingGrowth<>, CountingStats> v(SIZE);
+        v.EmplaceBack();
+        assert(v.GetStats().relocated_by_copy == SIZE);
+        assert(v.GetStats().relocated_by_move == 0);
+    }
+    {
+        Vector<int, std::allocator<int>, DoublingGrowth<>, CountingStats> v(SIZE);
+        v.Reserve(SIZE * 2);
+        assert(v.GetStats().relocated_bitwise == SIZE);
+
+        Vector<int, MallocAllocator<int>, DoublingGrowth<>, CountingStats> in_place(SIZE);
+        in_place.PushBack(1);
+        assert(in_place.GetStats().relocated_in_place == SIZE);
+        assert(in_place.GetStats().allocations == 2);
+    }
+}
+
+void Test17() {
+    const size_t SIZE = 10;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        const Vector<Obj> rhs(SIZE * 3);
+        Obj::ResetCounters();
+        v = rhs;
+        assert(v.Size() == SIZE * 3);
+        // Старые элементы перенесены и переиспользованы присваиванием, создан только хвост
+        assert(Obj::num_moved == static_cast<int>(SIZE));
+        assert(Obj::num_assigned == static_cast<int>(SIZE));
+        assert(Obj::num_copied == static_cast<int>(SIZE * 2));
+    }
+    {
+        Vector<std::string> v;
+        v.PushBack(std::string(100, 'a'));
+        const char* old_buffer = v[0].data();
+        Vector<std::string> rhs;
+        for (size_t i = 0; i < SIZE; ++i) {
+            rhs.PushBack(std::string(100, 'b'));
         }
-        Dump();
-    } catch (...) {
+        v = rhs;
+        assert(v.Size() == SIZE);
+        assert(v[0] == rhs[0]);
+        assert(v[0].data() == old_buffer);
+    }
+    {
+        Vector<int> v(SIZE);
+        const int source[] = {1, 2, 3, 4, 5};
+        v.Assign(std::begin(source), std::end(source));
+        assert(v.Size() == 5 && v[4] == 5);
+        v.Assign(SIZE * 2, v[1]);
+        assert(v.Size() == SIZE * 2);
+        assert(std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 2;
+        }));
+        std::istringstream input("7 8 9");
+        v.Assign(std::istream_iterator<int>(input), std::istream_iterator<int>{});
+        assert(v.Size() == 3 && v[0] == 7 && v[2] == 9);
+        std::istringstream more("1 2 3 4");
+        v.Assign(std::istream_iterator<int>(more), std::istream_iterator<int>{});
+        assert(v.Size() == 4 && v[3] == 4);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v(SIZE);
+            v.Assign(SIZE / 2, Obj{1});
+            assert(v.Size() == SIZE / 2 && v[0].id == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test18() {
+    {
+        // Все длины до нескольких векторных регистров, чтобы проверить хвосты ядер
+        for (size_t size = 0; size < 70; ++size) {
+            Vector<int32_t> ints(size);
+            Vector<float> floats(size);
+            Vector<uint32_t> uints(size);
+            for (size_t i = 0; i < size; ++i) {
+                ints[i] = static_cast<int32_t>(i % 7) - 3;
+                floats[i] = static_cast<float>(i % 5) * 0.5f;
+                uints[i] = static_cast<uint32_t>(i * 2654435761u);
+            }
+            for (int32_t value = -4; value <= 4; ++value) {
+                assert(Find(ints, value) == std::find(ints.begin(), ints.end(), value));
+                assert(Count(ints, value) == static_cast<size_t>(std::count(ints.begin(), ints.end(), value)));
+                const float f = static_cast<float>(value) * 0.5f;
+                assert(Find(floats, f) == std::find(floats.begin(), floats.end(), f));
+                assert(Count(floats, f) == static_cast<size_t>(std::count(floats.begin(), floats.end(), f)));
+            }
+            if (size > 0) {
+                assert(Contains(uints, uints[size - 1]));
+                const auto [min, max] = MinMax(uints);
+                assert(min == *std::min_element(uints.begin(), uints.end()));
+                assert(max == *std::max_element(uints.begin(), uints.end()));
+                const auto [int_min, int_max] = MinMax(ints);
+                assert(int_min == *std::min_element(ints.begin(), ints.end()));
+                assert(int_max == *std::max_element(ints.begin(), ints.end()));
+                const auto [float_min, float_max] = MinMax(floats);
+                assert(float_min == *std::min_element(floats.begin(), floats.end()));
+                assert(float_max == *std::max_element(floats.begin(), floats.end()));
+            }
+        }
+    }
+    {
+        Vector<float> v(20);
+        Fill(v, -0.0f);
+        assert(Count(v, 0.0f) == 20);
+        v[13] = std::numeric_limits<float>::quiet_NaN();
+        assert(!Contains(v, v[13]));
+        Vector<char> chars(33);
+        Fill(chars, 'x');
+        chars[31] = 'y';
+        assert(Find(chars, 'y') == chars.begin() + 31);
+        assert(!Contains(chars, 'z'));
+        const std::vector<int64_t> wide = {5, -1, 9, 3};
+        assert(MinMax(wide) == std::make_pair(int64_t{-1}, int64_t{9}));
+    }
+    {
+        Vector<int> a(100);
+        Vector<int> b(100);
+        assert(a == b);
+        b[99] = 1;
+        assert(a != b);
+        b.PopBack();
+        assert(a != b);
+        Vector<std::string> strings(3);
+        Vector<std::string> other(strings);
+        assert(strings == other);
+        other[1].push_back('x');
+        assert(strings != other);
+    }
+}
+
+void Test19() {
+    const auto is_aligned = [](const void* ptr, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+    };
+    {
+        struct alignas(128) OverAligned {
+            int value = 0;
+        };
+        Vector<OverAligned> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(OverAligned{i});
+            assert(is_aligned(&v[0], 128));
+        }
+        assert(v[9].value == 9);
+    }
+    {
+        Vector<float, AlignedAllocator<float>> v;
+        for (size_t i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.begin(), CACHE_LINE_SIZE));
+        }
+        const Vector<float, AlignedAllocator<float>> copy(v);
+        assert(is_aligned(copy.begin(), CACHE_LINE_SIZE));
+        assert(copy == v);
+    }
+    {
+        Vector<char, AlignedAllocator<char, HUGE_PAGE_SIZE>> v(HUGE_PAGE_SIZE);
+        assert(is_aligned(v.begin(), HUGE_PAGE_SIZE));
+        Fill(v, 'a');
+        assert(Count(v, 'a') == HUGE_PAGE_SIZE);
+    }
+}
+
+void Test20() {
+    // Больше MMAP_THRESHOLD: буфер отображается через mmap с заданными параметрами
+    const size_t SIZE = MmapAllocator<uint64_t>::MMAP_THRESHOLD / sizeof(uint64_t) + 1;
+    const MmapOptions OPTIONS[] = {
+        {HugePages::NONE, NumaPolicy::DEFAULT, 0},
+        {HugePages::TRANSPARENT, NumaPolicy::LOCAL, 0},
+        {HugePages::TRANSPARENT, NumaPolicy::INTERLEAVE, 0},
+        {HugePages::EXPLICIT, NumaPolicy::BIND, 1},
+    };
+    for (const MmapOptions& options : OPTIONS) {
+        using MmapVector = Vector<uint64_t, MmapAllocator<uint64_t>>;
+        MmapVector v{MmapAllocator<uint64_t>(options)};
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        if (options.huge_pages != HugePages::NONE) {
+            assert(reinterpret_cast<uintptr_t>(v.begin()) % HUGE_PAGE_SIZE == 0);
+        }
+        // Рост отображённого буфера
+        v.Reserve(v.Capacity() * 2);
+        assert(v.Size() == SIZE && v[SIZE - 1] == SIZE - 1);
+        const MmapVector copy(v);
+        assert(copy.GetAllocator() == v.GetAllocator());
+        assert(copy.GetAllocator().GetOptions() == options);
+        assert(copy == v);
+        v.Clear();
+        v.ShrinkToFit();
+    }
+}
+
+void Test21() {
+    const size_t SIZE = 1000;
+    const ParallelPolicy POLICY{4, 10};
+    {
+        ParallelObj::ResetCounters();
+        {
+            Vector<ParallelObj> v(SIZE, POLICY);
+            assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+            for (size_t i = 0; i < SIZE; ++i) {
+                v[i].id = static_cast<int>(i);
+            }
+            Vector<ParallelObj> copy(v, POLICY);
+            assert(ParallelObj::num_alive == static_cast<int>(SIZE * 2));
+            assert(copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+            // Переносятся копированием, т.к. перемещение может бросить
+            copy.Reserve(SIZE * 2, POLICY);
+            assert(copy.Capacity() == SIZE * 2);
+            assert(ParallelObj::num_alive == static_cast<int>(SIZE * 2));
+            assert(copy[SIZE / 2].id == static_cast<int>(SIZE / 2));
+
+            copy.Clear(POLICY);
+            assert(copy.Size() == 0);
+            assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+
+            v[SIZE / 3].throw_on_copy = true;
+            try {
+                Vector<ParallelObj> failed(v, POLICY);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+            try {
+                v.Reserve(SIZE * 2, POLICY);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            // Строгая гарантия: исходный буфер не изменился
+            assert(v.Capacity() == SIZE && v.Size() == SIZE);
+            assert(v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+            assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+        }
+        assert(ParallelObj::num_alive == 0);
+    }
+    {
+        ParallelObj::ResetCounters();
+        ParallelObj::construction_throw_countdown = static_cast<int>(SIZE / 2);
+        try {
+            Vector<ParallelObj> v(SIZE, POLICY);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(ParallelObj::num_alive == 0);
+    }
+    {
+        Vector<std::string> v(SIZE, POLICY);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = std::to_string(i) + " is long enough to be allocated on the heap";
+        }
+        v.Reserve(SIZE * 3, POLICY);
+        assert(v[SIZE - 1] == std::to_string(SIZE - 1) + " is long enough to be allocated on the heap");
+        Vector<int> ints(SIZE, POLICY);
+        assert(Count(ints, 0) == SIZE);
+        ints.Reserve(SIZE * 2, POLICY);
+        assert(ints.Capacity() == SIZE * 2);
+        // Маленький вектор обрабатывается в вызывающем потоке
+        const Vector<int> small(3, PARALLEL);
+        assert(small.Size() == 3);
+    }
+}
+
+void Test22() {
+    const size_t NUM_THREADS = 8;
+    const size_t PER_THREAD = 20000;
+    {
+        ConcurrentVector<size_t, 16> v;
+        v.PushBack(0);
+        const size_t* first = &v[0];
+        std::atomic<bool> done = false;
+        // Читатель проверяет опубликованные элементы одновременно с добавлением
+        std::thread reader([&] {
+            while (!done) {
+                const size_t size = v.Size();
+                for (size_t i = size > 100 ? size - 100 : 0; i < size; ++i) {
+                    assert(v[i] < NUM_THREADS * PER_THREAD + 1);
+                }
+            }
+        });
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            writers.emplace_back([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    const size_t& value = v.EmplaceBack(t * PER_THREAD + i + 1);
+                    assert(value == t * PER_THREAD + i + 1);
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        done = true;
+        reader.join();
+
+        assert(v.Size() == NUM_THREADS * PER_THREAD + 1);
+        // Рост не перемещает элементы
+        assert(&v[0] == first);
+        std::vector<size_t> values;
+        for (size_t i = 0; i < v.Size(); ++i) {
+            values.push_back(v[i]);
+        }
+        std::sort(values.begin(), values.end());
+        for (size_t i = 0; i < values.size(); ++i) {
+            assert(values[i] == i);
+        }
+    }
+    {
+        ConcurrentVector<std::string> v;
+        v.Reserve(1000);
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            writers.emplace_back([&v] {
+                for (size_t i = 0; i < 1000; ++i) {
+                    v.EmplaceBack(100, 'a');
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        assert(v.Size() == NUM_THREADS * 1000);
+        assert(v[v.Size() - 1] == std::string(100, 'a'));
+    }
+}
+
+void Test23() {
+    static_assert(std::random_access_iterator<SegmentedVector<int>::iterator>);
+    static_assert(std::random_access_iterator<SegmentedVector<int>::const_iterator>);
+    const size_t SIZE = 1000;
+    {
+        // Перемещение Obj не бросает, но и при росте элементы не переносятся вовсе
+        Obj::ResetCounters();
+        {
+            SegmentedVector<Obj, 4> v;
+            v.EmplaceBack(0);
+            const Obj* first = &v[0];
+            for (size_t i = 1; i < SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(&v[0] == first);
+            assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+            assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+            for (size_t i = 0; i < SIZE; ++i) {
+                assert(v[i].id == static_cast<int>(i));
+            }
+            const SegmentedVector<Obj, 4> copy(v);
+            assert(std::equal(copy.begin(), copy.end(), v.begin(), [](const Obj& lhs, const Obj& rhs) {
+                return lhs.id == rhs.id;
+            }));
+            v.PopBack();
+            assert(v.Size() == SIZE - 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        SegmentedVector<int> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        auto it = v.begin();
+        it += 500;
+        assert(*it == 500 && it[10] == 510 && *(it - 100) == 400);
+        assert(v.end() - v.begin() == static_cast<std::ptrdiff_t>(SIZE));
+        --it;
+        assert(*it == 499);
+        size_t visited = 0;
+        long long sum = 0;
+        v.ForEachSegment([&](std::span<int> elements) {
+            visited += elements.size();
+            for (int x : elements) {
+                sum += x;
+            }
+        });
+        assert(visited == SIZE);
+        assert(sum == std::accumulate(v.begin(), v.end(), 0LL));
+        std::sort(v.begin(), v.end(), std::greater<>());
+        assert(v[0] == static_cast<int>(SIZE) - 1 && v[SIZE - 1] == 0);
+        SegmentedVector<int> moved(std::move(v));
+        assert(moved.Size() == SIZE && v.Size() == 0);
+        v = moved;
+        assert(v.Size() == SIZE && v[1] == moved[1]);
+    }
+    {
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 10;
+        try {
+            SegmentedVector<Obj> v(SIZE);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test24() {
+    const size_t SIZE = 100;
+    {
+        Vector<std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        const std::string* data = &v[0];
+        ReleasedBuffer<std::string> buffer = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(buffer.data == data && buffer.size == SIZE && buffer.capacity >= SIZE);
+
+        Vector<std::string> other;
+        other.Adopt(buffer.data, buffer.size, buffer.capacity);
+        assert(&other[0] == data && other[SIZE - 1] == std::to_string(SIZE - 1));
+    }
+    {
+        int num_deleted = 0;
+        int* buf = static_cast<int*>(std::malloc(SIZE * sizeof(int)));
+        std::iota(buf, buf + SIZE, 0);
+        {
+            ExternalVector<int> v = AdoptBuffer(buf, SIZE, SIZE, [&num_deleted](int* data, size_t capacity) {
+                assert(capacity == SIZE);
+                ++num_deleted;
+                std::free(data);
+            });
+            assert(v.begin() == buf && v[SIZE - 1] == static_cast<int>(SIZE - 1));
+            const ExternalVector<int> copy(v);
+            assert(copy.begin() != buf && copy == v);
+            // Рост переносит элементы в обычную память и освобождает чужой буфер
+            v.PushBack(-1);
+            assert(num_deleted == 1);
+            assert(v[0] == 0 && v[SIZE] == -1);
+        }
+        assert(num_deleted == 1);
+    }
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "advanced_vector_test.bin";
+        {
+            std::ofstream file(path, std::ios::binary);
+            for (uint32_t i = 0; i < SIZE; ++i) {
+                file.write(reinterpret_cast<const char*>(&i), sizeof(i));
+            }
+            file.write("xy", 2);
+        }
+        {
+            ExternalVector<uint32_t> v = MapFile<uint32_t>(path);
+            assert(v.Size() == SIZE && v[SIZE - 1] == SIZE - 1);
+            v[0] = 42;
+            const ExternalVector<uint32_t> again = MapFile<uint32_t>(path);
+            assert(again[0] == 0);
+            v.PushBack(7);
+            assert(v[0] == 42 && v[SIZE] == 7);
+        }
+        std::filesystem::remove(path);
+        try {
+            MapFile<uint32_t>(path);
+            assert(false);
+        } catch (const std::system_error& e) {
+            assert(e.code() == std::errc::no_such_file_or_directory);
+        }
+    }
+}
+
+void Test25() {
+    struct Row {
+        uint64_t id;
+        double value;
+    };
+    const size_t SIZE = 10000;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "advanced_vector_persistent.bin";
+    {
+        PersistentVector<Row> v(path, PersistentMode::TRUNCATE);
+        assert(v.Size() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack({i, static_cast<double>(i) / 2});
+        }
+        // Аргумент ссылается на элемент, который переедет при росте отображения
+        while (v.Size() != v.Capacity()) {
+            v.PushBack({1, 1});
+        }
+        v.PushBack(v[0]);
+        assert(v[v.Size() - 1].id == 0);
+        v.PopBack();
+        v.Resize(SIZE);
+        v.Flush();
+    }
+    {
+        const PersistentVector<Row> reader(path, PersistentMode::READ_ONLY);
+        const PersistentVector<Row> other_reader(path, PersistentMode::READ_ONLY);
+        assert(reader.IsReadOnly());
+        assert(reader.Size() == SIZE && reader[SIZE - 1].id == SIZE - 1);
+        assert(other_reader[SIZE / 2].value == static_cast<double>(SIZE / 2) / 2);
+    }
+    {
+        PersistentVector<Row> v(path, PersistentMode::READ_WRITE);
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        v.Reserve(SIZE * 4);
+        v.EmplaceBack(Row{1, 2});
+        PersistentVector<Row> moved(std::move(v));
+        assert(moved.Size() == SIZE + 1 && moved.Capacity() == SIZE * 4);
+        // Перемещённый вектор пуст
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == v.end());
+        v.Clear();
+        v.Resize(0);
+        assert(v.Size() == 0);
+        v.Flush();
+    }
+    try {
+        PersistentVector<Row, 1> v(path, PersistentMode::READ_ONLY);
+        assert(false);
+    } catch (const std::runtime_error& e) {
+        assert(std::string(e.what()).find("layout") != std::string::npos);
+    }
+    try {
+        PersistentVector<uint32_t> v(path, PersistentMode::READ_WRITE);
+        assert(false);
+    } catch (const std::runtime_error&) {
+    }
+    std::filesystem::remove(path);
+    try {
+        PersistentVector<Row> v(path, PersistentMode::READ_ONLY);
+        assert(false);
+    } catch (const std::system_error& e) {
+        assert(e.code() == std::errc::no_such_file_or_directory);
+    }
+}
+
+void Test26() {
+    const size_t SIZE = 10;
+    {
+        // Тривиально перемещаемый тип: хвост сдвигается memmove, элемент создаётся на месте
+        Vector<RelocatableObj> v;
+        v.Reserve(SIZE * 2);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        RelocatableObj::ResetCounters();
+        auto* pos = v.Emplace(v.cbegin() + 3, 100);
+        assert(pos == v.begin() + 3 && pos->id == 100);
+        assert(RelocatableObj::num_moved == 0 && RelocatableObj::num_copied == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(v[4].id == 3 && v[SIZE].id == static_cast<int>(SIZE - 1));
+        // Аргумент из сдвигаемой части вектора
+        v.Insert(v.cbegin() + 1, v[5]);
+        assert(v[1].id == 4 && v[6].id == 4);
+        assert(RelocatableObj::num_copied == 1 && RelocatableObj::num_moved == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        const Obj obj(5);
+        Obj::ResetCounters();
+        // Вставляемое значение присваивается прямо на место, без временного объекта
+        v.Insert(v.cbegin() + 2, obj);
+        assert(v[2].id == 5);
+        assert(Obj::num_copied == 0 && Obj::num_assigned == 1);
+        assert(Obj::num_moved == 1);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 3));
+        Obj::ResetCounters();
+        v.Insert(v.cbegin() + 2, Obj(7));
+        assert(v[2].id == 7 && v[3].id == 5);
+        assert(Obj::num_moved == 1 && Obj::num_copied == 0);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 1));
+    }
+    {
+        // Конструктор без исключений: сдвинутый элемент пересоздаётся на месте
+        Vector<TestObj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v.Emplace(v.cbegin() + 1);
+        assert(v.Size() == SIZE + 1);
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+}
+
+// Ключ без конструктора по умолчанию
+struct NoDefaultKey {
+    explicit NoDefaultKey(int value)
+        : value(value) {
+    }
+
+    friend bool operator<(const NoDefaultKey& lhs, const NoDefaultKey& rhs) noexcept {
+        return lhs.value < rhs.value;
+    }
+
+    int value;
+};
+
+void Test27() {
+    {
+        // Сравнение с std::lower_bound на всех длинах и для ключей между элементами
+        for (size_t n = 0; n < 40; ++n) {
+            Vector<int> keys;
+            for (size_t i = 0; i < n; ++i) {
+                keys.PushBack(static_cast<int>(i * 2));
+            }
+            for (int key = -1; key <= static_cast<int>(n * 2); ++key) {
+                const size_t expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+                assert(detail::BranchlessLowerBound(keys.begin(), n, key, std::less<int>()) == expected);
+            }
+        }
+    }
+    for (LookupMode mode : {LookupMode::BINARY, LookupMode::EYTZINGER}) {
+        FlatSet<int> set(std::less<int>(), mode);
+        std::set<int> expected;
+        for (int i = 0; i < 200; ++i) {
+            const int key = (i * 37) % 101;
+            assert(set.Insert(key) == expected.insert(key).second);
+        }
+        const std::vector<int> sorted = {-5, 3, 3, 50, 150, 151};
+        set.InsertSorted(sorted.begin(), sorted.end());
+        expected.insert(sorted.begin(), sorted.end());
+        assert(set.Erase(50) && !set.Erase(50));
+        expected.erase(50);
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+        for (int key = -10; key < 160; ++key) {
+            assert(set.Contains(key) == (expected.count(key) == 1));
+            const size_t expected_bound = std::distance(expected.begin(), expected.lower_bound(key));
+            assert(set.LowerBound(key) == expected_bound);
+        }
+        assert(set.Find(1000) == set.end());
+    }
+    {
+        FlatMap<int, std::string> map(std::less<int>(), LookupMode::EYTZINGER);
+        assert(map.Insert(10, "ten"));
+        assert(!map.Insert(10, "TEN"));
+        map[5] = "five";
+        const std::vector<std::pair<int, std::string>> sorted = {{1, "one"}, {5, "FIVE"}, {7, "seven"}, {20, "twenty"}};
+        map.InsertSorted(sorted.begin(), sorted.end());
+        assert(map.Size() == 5);
+        assert(map.At(5) == "five" && map.At(7) == "seven");
+        assert(map.Keys()[0] == 1 && map.Values()[0] == "one");
+        assert(map.Erase(10) && map.Find(10) == nullptr);
+        assert(*map.Find(20) == "twenty");
+        try {
+            map.At(10);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        map.SetLookupMode(LookupMode::BINARY);
+        assert(map.Contains(1) && !map.Contains(2));
+    }
+    for (LookupMode mode : {LookupMode::BINARY, LookupMode::EYTZINGER}) {
+        FlatSet<NoDefaultKey> set(std::less<NoDefaultKey>(), mode);
+        FlatMap<NoDefaultKey, int> map(std::less<NoDefaultKey>(), mode);
+        for (int i = 0; i < 50; ++i) {
+            set.Insert(NoDefaultKey((i * 7) % 50));
+            map.Insert(NoDefaultKey(i), i * 2);
+        }
+        assert(set.Size() == 50 && set.Contains(NoDefaultKey(49)) && !set.Contains(NoDefaultKey(50)));
+        assert(set.LowerBound(NoDefaultKey(10)) == 10);
+        assert(map.At(NoDefaultKey(21)) == 42);
+    }
+}
+
+void Test28() {
+    const size_t SIZE = 100;
+    {
+        SoaVector<int, double, std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i), static_cast<double>(i) / 2, std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        auto [id, value, name] = v[10];
+        assert(id == 10 && value == 5.0 && name == "10");
+        name = "ten";
+        assert(std::get<2>(v[10]) == "ten");
+        v[11] = std::make_tuple(-1, -1.0, std::string("x"));
+        assert(std::get<0>(v[11]) == -1);
+
+        const std::span<const int> ids = std::as_const(v).Column<0>();
+        assert(ids.size() == SIZE && ids[SIZE - 1] == static_cast<int>(SIZE - 1));
+        double sum = 0;
+        for (double x : v.Column<1>()) {
+            sum += x;
+        }
+        assert(sum > 0);
+
+        // Аргументы ссылаются на строку самого вектора во время роста
+        while (v.Size() != v.Capacity()) {
+            v.PushBack(0, 0, "");
+        }
+        v.EmplaceBack(std::get<0>(v[0]), std::get<1>(v[0]), std::get<2>(v[0]));
+        assert(std::get<2>(v[v.Size() - 1]) == "0");
+
+        SoaVector<int, double, std::string> copy(v);
+        assert(copy.Size() == v.Size() && std::get<2>(copy[10]) == "ten");
+        copy.Resize(5);
+        copy.PopBack();
+        assert(copy.Size() == 4);
+        v = std::move(copy);
+        assert(v.Size() == 4);
+    }
+    {
+        // Столбец, перенос которого копирует (перемещение может бросить), откатывает
+        // весь Reserve, не затронув столбцы, переносимые перемещением
+        ParallelObj::ResetCounters();
+        {
+            SoaVector<std::string, ParallelObj> v;
+            v.Reserve(4);
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(std::string(100, 'a'), ParallelObj());
+            }
+            std::get<1>(v[2]).throw_on_copy = true;
+            try {
+                v.Reserve(8);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Capacity() == 4 && std::get<0>(v[3]) == std::string(100, 'a'));
+            assert(ParallelObj::num_alive == 4);
+        }
+        assert(ParallelObj::num_alive == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            SoaVector<std::string, Obj> v(SIZE);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test29() {
+    BufferCache& cache = BufferCache::Local();
+    cache.Trim();
+    const size_t limit = cache.Limit();
+    {
+        // Повторно созданный вектор того же размера получает буфер из кэша
+        const size_t hits = cache.Hits();
+        for (int i = 0; i < 10; ++i) {
+            Vector<int, CachingAllocator<int>> v;
+            v.Reserve(100);
+            v.PushBack(i);
+        }
+        assert(cache.Hits() >= hits + 9);
+        assert(cache.CachedBytes() == 512);
+    }
+    {
+        // Буфер любого размера внутри класса подходит
+        void* buf = BufferCache::Allocate(200);
+        BufferCache::Deallocate(buf, 200);
+        const size_t hits = cache.Hits();
+        void* same = BufferCache::Allocate(129);
+        assert(same == buf && cache.Hits() == hits + 1);
+        BufferCache::Deallocate(same, 129);
+    }
+    {
+        // Слишком большие буферы не кэшируются
+        const size_t cached = cache.CachedBytes();
+        Vector<char, CachingAllocator<char>> v;
+        v.Reserve(BufferCache::MAX_BUFFER_BYTES + 1);
+        v = {};
+        assert(cache.CachedBytes() == cached);
+    }
+    {
+        cache.SetLimit(1024);
+        assert(cache.CachedBytes() <= 1024);
+        void* a = BufferCache::Allocate(1024);
+        void* b = BufferCache::Allocate(1024);
+        cache.Trim();
+        BufferCache::Deallocate(a, 1024);
+        BufferCache::Deallocate(b, 1024);
+        assert(cache.CachedBytes() == 1024);
+        cache.SetLimit(0);
+        assert(cache.CachedBytes() == 0);
+        Vector<int, CachingAllocator<int>> v(10);
+        v = {};
+        assert(cache.CachedBytes() == 0);
+        cache.SetLimit(limit);
+    }
+    {
+        // У каждого потока свой кэш; буфер, освобождённый в другом потоке, остаётся в его кэше,
+        // даже если тот поток до этого ничего не выделял
+        Vector<std::string, CachingAllocator<std::string>> v(100);
+        const size_t cached = cache.CachedBytes();
+        std::thread([&v] {
+            Vector<std::string, CachingAllocator<std::string>> moved(std::move(v));
+            moved = {};
+            BufferCache& thread_cache = BufferCache::Local();
+            assert(thread_cache.CachedBytes() > 0 && thread_cache.Misses() == 0);
+        }).join();
+        assert(cache.CachedBytes() == cached);
+    }
+    cache.Trim();
+    assert(cache.CachedBytes() == 0);
+}
+
+// Таблица квадратов, построенная Vector на этапе компиляции
+template <size_t N>
+constexpr std::array<int, N> MakeSquaresTable() {
+    Vector<int> squares;
+    for (size_t i = 0; i < N; ++i) {
+        squares.PushBack(static_cast<int>(i * i));
+    }
+    std::array<int, N> table{};
+    std::copy(squares.begin(), squares.end(), table.begin());
+    return table;
+}
+
+struct ConstexprPoint {
+    constexpr explicit ConstexprPoint(int x)
+        : x(x) {
+    }
+
+    constexpr ConstexprPoint(const ConstexprPoint& other)
+        : x(other.x) {
+    }
+
+    constexpr ConstexprPoint& operator=(const ConstexprPoint& rhs) {
+        x = rhs.x;
+        return *this;
+    }
+
+    constexpr ~ConstexprPoint() {
+    }
+
+    friend constexpr bool operator==(const ConstexprPoint&, const ConstexprPoint&) = default;
+
+    int x;
+};
+
+void Test30() {
+    {
+        constexpr auto table = MakeSquaresTable<16>();
+        static_assert(table[0] == 0 && table[5] == 25 && table[15] == 225);
+    }
+    {
+        static_assert([] {
+            Vector<int> v(5);
+            v.Insert(v.begin() + 2, 7);
+            v.Insert(v.begin(), v[2]);
+            const int values[] = {1, 2, 3};
+            v.Insert(v.end(), std::begin(values), std::end(values));
+            v.Erase(v.begin() + 1, v.begin() + 3);
+            EraseIf(v, [](int x) { return x == 2; });
+            Vector<int> copy = v;
+            copy.Resize(10);
+            copy.ShrinkToFit();
+            Vector<int> moved(std::move(copy));
+            moved.Assign(3, 4);
+            return v.Size() == 7 && v[0] == 7 && v[1] == 7 && v[6] == 3 && moved.Size() == 3 && moved[2] == 4
+                && moved.Capacity() == 10 && v == Vector<int>(v);
+        }());
+        // Нетривиальный тип идёт через поэлементные перемещения вместо memmove и memcpy
+        static_assert([] {
+            Vector<ConstexprPoint> v;
+            for (int i = 0; i < 5; ++i) {
+                v.EmplaceBack(i);
+            }
+            v.Emplace(v.begin() + 1, v[4]);
+            v.Erase(v.begin());
+            v.Reserve(100);
+            return v.Size() == 5 && v[0].x == 4 && v[1].x == 1 && v[4].x == 4;
+        }());
+    }
+    {
+        static_assert([] {
+            StaticVector<int, 8> v;
+            for (int i = 0; i < 8; ++i) {
+                v.PushBack(i);
+            }
+            const bool full = v.IsFull() && v.TryEmplaceBack(8) == nullptr;
+            v.Erase(v.begin(), v.begin() + 2);
+            v.Insert(v.begin(), 42);
+            EraseIf(v, [](int x) { return x % 2 == 1; });
+            return full && v.Size() == 4 && v[0] == 42 && v[1] == 2 && v[3] == 6;
+        }());
+        static_assert(std::is_trivially_destructible_v<StaticVector<int, 4>>);
+        static_assert(!std::is_trivially_destructible_v<StaticVector<std::string, 4>>);
+    }
+    {
+        StaticVector<std::string, 4> v;
+        v.PushBack("a");
+        v.EmplaceBack(3, 'b');
+        v.Insert(v.begin(), v[1]);
+        assert(v.Size() == 3 && v[0] == "bbb" && v[1] == "a" && v[2] == "bbb");
+        assert(v.TryEmplaceBack("c") != nullptr && v.TryEmplaceBack("d") == nullptr);
+
+        StaticVector<std::string, 4> other;
+        other.PushBack("x");
+        v.Swap(other);
+        assert(v.Size() == 1 && v[0] == "x" && other.Size() == 4 && other[3] == "c");
+
+        StaticVector<std::string, 4> moved(std::move(other));
+        assert(moved.Size() == 4 && other.Size() == 0);
+        StaticVector<std::string, 4> copy = moved;
+        assert(copy == moved);
+        copy.Resize(1);
+        copy = moved;
+        assert(copy == moved);
+        static_assert(sizeof(StaticVector<std::string, 4>) == 4 * sizeof(std::string) + sizeof(size_t));
+    }
+    {
+        // Элементы живут столько же, сколько занимают место в векторе
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 6> v(3);
+            v.EmplaceBack(1);
+            v.Erase(v.begin());
+            v.PopBack();
+            assert(Obj::GetAliveObjectCount() == 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test31() {
+    struct Record {
+        uint32_t id;
+        double value;
+    };
+    const size_t SIZE = 10000;
+    Vector<Record> records;
+    for (uint32_t i = 0; i < SIZE; ++i) {
+        records.PushBack({i, i * 0.5});
+    }
+    const auto same_records = [&records](const Vector<Record>& v) {
+        return v.Size() == records.Size() && std::equal(v.begin(), v.end(), records.begin(), [](Record a, Record b) {
+                   return a.id == b.id && a.value == b.value;
+               });
+    };
+    {
+        std::stringstream stream;
+        WriteTo(stream, records);
+        Vector<Record> v(3);
+        ReadFrom(stream, v);
+        assert(same_records(v));
+
+        // Повреждённые данные не меняют вектор
+        std::string data = stream.str();
+        std::istringstream truncated(data.substr(0, data.size() - 1));
+        try {
+            ReadFrom(truncated, v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        std::istringstream wrong_type(data);
+        Vector<uint64_t> other(2);
+        try {
+            ReadFrom(wrong_type, other);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(same_records(v) && other.Size() == 2);
+        std::istringstream garbage("not a vector at all, definitely");
+        try {
+            ReadFrom(garbage, v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+    }
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "advanced_vector_io.bin";
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        assert(fd >= 0);
+        WriteTo(fd, records);
+        WriteTo(fd, Vector<Record>());
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        Vector<Record> v;
+        ReadFrom(fd, v);
+        assert(same_records(v));
+        ReadFrom(fd, v);
+        assert(v.Size() == 0);
+        close(fd);
+        std::filesystem::remove(path);
+    }
+    {
+        // Поток неизвестной длины читается ReadFrom целиком
+        std::stringstream stream;
+        VectorStreamWriter<Record> writer(stream);
+        for (size_t first = 0; first < SIZE; first += 1000) {
+            writer.Append({records.begin() + first, 1000});
+        }
+        Vector<Record> v;
+        ReadFrom(stream, v);
+        assert(same_records(v));
+    }
+    {
+        // Читатель получает элементы частями по мере поступления из канала, в том числе
+        // элементы, разрезанные между двумя записями
+        int fds[2];
+        assert(pipe(fds) == 0);
+        std::thread producer([&records, write_fd = fds[1]] {
+            VectorStreamWriter<Record> writer(write_fd);
+            const auto* bytes = reinterpret_cast<const std::byte*>(records.begin());
+            const size_t total = records.Size() * sizeof(Record);
+            for (size_t offset = 0; offset < total; offset += 1000) {
+                detail::WriteAll(write_fd, bytes + offset, std::min<size_t>(1000, total - offset), nullptr, 0);
+            }
+            close(write_fd);
+        });
+        VectorStreamReader<Record> reader(fds[0]);
+        Vector<Record> v;
+        size_t num_reads = 0;
+        while (reader.ReadInto(v, 500) != 0) {
+            ++num_reads;
+        }
+        producer.join();
+        close(fds[0]);
+        assert(reader.AtEnd() && num_reads >= SIZE / 500);
+        assert(same_records(v));
+    }
+    {
+        std::stringstream stream;
+        WriteTo(stream, records);
+        VectorStreamReader<Record> reader(stream);
+        Vector<Record> v;
+        assert(reader.ReadInto(v, SIZE - 1) == SIZE - 1);
+        assert(!reader.AtEnd());
+        assert(reader.ReadInto(v, 100) == 1 && reader.AtEnd());
+        assert(reader.ReadInto(v, 100) == 0);
+        assert(same_records(v));
+
+        std::string data = stream.str();
+        std::istringstream truncated(data.substr(0, data.size() - 3));
+        VectorStreamReader<Record> truncated_reader(truncated);
+        size_t size_before_read = v.Size();
+        try {
+            while (truncated_reader.ReadInto(v, 1000) != 0) {
+                size_before_read = v.Size();
+            }
+            assert(false);
+        } catch (const std::runtime_error&) {
+            // Элементы, прочитанные неудавшимся вызовом, не остаются в векторе
+            assert(v.Size() == size_before_read);
+        }
+    }
+}
+
+void Test32() {
+    const ParallelPolicy policy{4, 1000};
+    {
+        // Задачи разной длительности распределяются между потоками, исключение пробрасывается
+        ThreadPool pool(4);
+        std::atomic<size_t> sum = 0;
+        pool.Run(1000, 0, [&sum](size_t i) {
+            if (i < 10) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            sum += i;
+        });
+        assert(sum == 999 * 1000 / 2);
+        try {
+            pool.Run(100, 0, [](size_t i) {
+                if (i == 50) {
+                    throw std::runtime_error("task");
+                }
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        // Вложенный Run выполняется в потоке задачи
+        std::atomic<size_t> nested = 0;
+        pool.Run(8, 0, [&pool, &nested](size_t) {
+            pool.Run(8, 0, [&nested](size_t) {
+                ++nested;
+            });
+        });
+        assert(nested == 64);
+    }
+    {
+        const size_t SIZE = 100000;
+        std::mt19937_64 random(42);
+        Vector<int64_t> numbers;
+        std::vector<int64_t> expected;
+        for (size_t i = 0; i < SIZE; ++i) {
+            const int64_t value = static_cast<int64_t>(random()) >> (i % 40);
+            numbers.PushBack(value);
+            expected.push_back(value);
+        }
+        std::sort(expected.begin(), expected.end());
+        Vector<int64_t> copy = numbers;
+        ParallelSort(numbers, policy);
+        assert(std::equal(numbers.begin(), numbers.end(), expected.begin(), expected.end()));
+
+        // Старшие байты одинаковы: проходы по ним пропускаются
+        Vector<uint32_t> small(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            small[i] = static_cast<uint32_t>(random() % 1000);
+        }
+        ParallelSort(small, policy);
+        assert(std::is_sorted(small.begin(), small.end()));
+
+        ParallelSort(copy, std::greater<>{}, policy);
+        assert(std::equal(copy.begin(), copy.end(), expected.rbegin(), expected.rend()));
+    }
+    {
+        const size_t SIZE = 20000;
+        Vector<std::string> names;
+        for (size_t i = 0; i < SIZE; ++i) {
+            names.PushBack(std::to_string(i * 7919 % SIZE));
+        }
+        ParallelSort(
+            names,
+            [](const std::string& lhs, const std::string& rhs) {
+                return lhs.size() != rhs.size() ? lhs.size() < rhs.size() : lhs < rhs;
+            },
+            policy);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(names[i] == std::to_string(i));
+        }
+    }
+    {
+        Vector<int> v(100000);
+        ParallelForEach(
+            v,
+            [](int& x) {
+                x = 1;
+            },
+            policy);
+        ParallelTransform(
+            v,
+            [](int x) {
+                return x * 3;
+            },
+            policy);
+        Vector<double> halves;
+        ParallelTransform(
+            v, halves,
+            [](int x) {
+                return x / 2.0;
+            },
+            policy);
+        assert(halves.Size() == v.Size() && halves[0] == 1.5 && halves[v.Size() - 1] == 1.5);
+        assert(ParallelReduce(v, int64_t{0}, std::plus<>{}, policy) == 300000);
+
+        // Операция без коммутативности: порядок элементов сохраняется
+        Vector<std::string> digits;
+        for (int i = 0; i < 5000; ++i) {
+            digits.PushBack(std::to_string(i % 10));
+        }
+        const std::string joined = ParallelReduce(digits, std::string(), std::plus<>{}, ParallelPolicy{4, 100});
+        std::string expected;
+        for (int i = 0; i < 5000; ++i) {
+            expected += std::to_string(i % 10);
+        }
+        assert(joined == expected);
+    }
+}
+
+void Test33() {
+    {
+        // Вставки с обоих концов не сдвигают элементы
+        GapVector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushFront(-i - 1);
+            v.PushBack(i);
+        }
+        assert(v.Size() == 2000 && v.Capacity() < 8000);
+        for (int i = 0; i < 2000; ++i) {
+            assert(v[i] == i - 1000);
+        }
+        assert(std::is_sorted(v.begin(), v.end()));
+        v.PopFront();
+        v.PopBack();
+        assert(v.Size() == 1998 && v[0] == -999 && v[1997] == 998);
+
+        // Очередь: запас перераспределяется, ёмкость не растёт вместе с числом операций
+        GapVector<int> queue;
+        for (int i = 0; i < 100000; ++i) {
+            queue.PushBack(i);
+            if (queue.Size() > 100) {
+                queue.PopFront();
+            }
+        }
+        assert(queue.Size() == 100 && queue[0] == 99900 && queue.Capacity() <= 1000);
+    }
+    {
+        // Правки рядом с курсором, сверенные с std::vector
+        std::mt19937 random(7);
+        GapVector<std::string> text;
+        std::vector<std::string> expected;
+        size_t cursor = 0;
+        for (int step = 0; step < 5000; ++step) {
+            const unsigned action = random() % 10;
+            if (action < 6 || expected.empty()) {
+                text.Insert(text.cbegin() + cursor, std::to_string(step));
+                expected.insert(expected.begin() + cursor, std::to_string(step));
+                ++cursor;
+            } else if (action < 8) {
+                const size_t index = std::min(cursor, expected.size() - 1);
+                auto it = text.Erase(text.cbegin() + index);
+                assert(it == text.begin() + index);
+                expected.erase(expected.begin() + index);
+                cursor = index;
+            } else {
+                cursor = random() % (expected.size() + 1);
+            }
+        }
+        assert(std::equal(text.begin(), text.end(), expected.begin(), expected.end()));
+
+        // Аргумент ссылается на элемент, сдвигаемый переносом промежутка
+        text.MoveGap(0);
+        text.Insert(text.cbegin() + 10, text[text.Size() - 1]);
+        expected.insert(expected.begin() + 10, expected.back());
+        text.EmplaceFront(text[3]);
+        expected.insert(expected.begin(), expected[3]);
+
+        const GapVector<std::string> copy = text;
+        const std::string* data = text.Data();
+        assert(std::equal(data, data + text.Size(), expected.begin(), expected.end()));
+        assert(std::equal(copy.begin(), copy.end(), expected.begin(), expected.end()));
+        // После Data промежуток у одного из концов
+        assert(text.GapPosition() == 0 || text.GapPosition() == text.Size());
+    }
+    {
+        Obj::ResetCounters();
+        {
+            GapVector<Obj> v;
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceFront(i);
+                v.Emplace(v.cbegin() + v.Size() / 2, i);
+            }
+            v.MoveGap(10);
+            v.Erase(v.cbegin() + 50);
+            GapVector<Obj> moved = std::move(v);
+            assert(moved.Size() == 199 && v.Size() == 0);
+            v = moved;
+            v.Clear();
+            v.PushBack(Obj(1));
+            assert(v.Size() == 1 && v[0].id == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+// Конструктор перемещения не помечен noexcept; Tag различает типы с разными политиками
+template <int Tag>
+struct MayThrowOnMove {
+    MayThrowOnMove(int value = 0)
+        : value(value) {
+    }
+
+    MayThrowOnMove(const MayThrowOnMove& other)
+        : value(other.value) {
+        ++num_copied;
+    }
+
+    MayThrowOnMove(MayThrowOnMove&& other)
+        : value(other.value) {
+        if (move_throw_countdown > 0 && --move_throw_countdown == 0) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_moved;
+    }
+
+    MayThrowOnMove& operator=(const MayThrowOnMove&) = default;
+    MayThrowOnMove& operator=(MayThrowOnMove&&) = default;
+
+    int value = 0;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int move_throw_countdown = 0;
+};
+
+template <>
+struct CopyFallbackPolicy<MayThrowOnMove<1>> : std::integral_constant<CopyFallback, CopyFallback::REPORT> {
+};
+
+template <>
+struct CopyFallbackPolicy<MayThrowOnMove<2>> : std::integral_constant<CopyFallback, CopyFallback::MOVE> {
+};
+
+struct CopyFallbackReports {
+    static void Record(std::string_view type_name, size_t count) {
+        names.emplace_back(type_name);
+        counts.push_back(count);
+    }
+
+    static inline std::vector<std::string> names;
+    static inline std::vector<size_t> counts;
+};
+
+void Test34() {
+    const size_t SIZE = 100;
+    {
+        // По умолчанию перенос копирует
+        Vector<MayThrowOnMove<0>, std::allocator<MayThrowOnMove<0>>, DoublingGrowth<>, CountingStats> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.GetStats().relocated_by_copy > 0 && v.GetStats().relocated_by_move == 0);
+        assert(MayThrowOnMove<0>::num_moved == 0);
+    }
+    {
+        const CopyFallbackHandler previous = SetCopyFallbackHandler(&CopyFallbackReports::Record);
+        Vector<MayThrowOnMove<1>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        SmallVector<MayThrowOnMove<1>, 2> small(3);
+        SetCopyFallbackHandler(previous);
+
+        // Сообщение одно, с именем типа и числом элементов первого переноса
+        assert(CopyFallbackReports::names.size() == 1 && CopyFallbackReports::counts[0] == 1);
+        assert(CopyFallbackReports::names[0].find("MayThrowOnMove<1>") != std::string::npos);
+        assert(MayThrowOnMove<1>::num_copied > static_cast<int>(SIZE) && MayThrowOnMove<1>::num_moved == 0);
+        assert(v.Size() == SIZE && v[SIZE - 1].value == static_cast<int>(SIZE - 1));
+    }
+    {
+        // Перемещение вместо копирования во всех контейнерах, переносящих элементы
+        Vector<MayThrowOnMove<2>, std::allocator<MayThrowOnMove<2>>, DoublingGrowth<>, CountingStats> v;
+        GapVector<MayThrowOnMove<2>> gap;
+        SoaVector<MayThrowOnMove<2>, int> soa;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+            v.Emplace(v.cbegin(), static_cast<int>(i));
+            gap.EmplaceBack(static_cast<int>(i));
+            soa.EmplaceBack(static_cast<int>(i), static_cast<int>(i));
+        }
+        gap.MoveGap(0);
+        assert(v.GetStats().relocated_by_copy == 0 && v.GetStats().relocated_by_move > 0);
+        assert(MayThrowOnMove<2>::num_copied == 0);
+        assert(v[0].value == static_cast<int>(SIZE - 1) && v[2 * SIZE - 1].value == static_cast<int>(SIZE - 1));
+        assert(gap[SIZE - 1].value == static_cast<int>(SIZE - 1) && std::get<0>(soa[SIZE - 1]).value == static_cast<int>(SIZE - 1));
+    }
+    {
+        // Перемещение бросило исключение посреди роста: остальные столбцы ещё не перенесены
+        SoaVector<std::string, MayThrowOnMove<2>, int> soa;
+        for (int i = 0; i < 8; ++i) {
+            soa.EmplaceBack(std::to_string(i), i, i);
+        }
+        assert(soa.Capacity() == 8);
+        MayThrowOnMove<2>::move_throw_countdown = 4;
+        try {
+            soa.EmplaceBack("8", 8, 8);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        MayThrowOnMove<2>::move_throw_countdown = 0;
+        assert(soa.Size() == 8 && soa.Capacity() == 8);
+        for (int i = 0; i < 8; ++i) {
+            assert(std::get<0>(soa[i]) == std::to_string(i) && std::get<2>(soa[i]) == i);
+        }
+        soa.EmplaceBack("8", 8, 8);
+        assert(std::get<0>(soa[8]) == "8" && std::get<1>(soa[8]).value == 8);
+    }
+    {
+        Vector<NothrowMoveObj> v;
+        SmallVector<NothrowMoveObj, 2> small;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(NothrowMoveObj(static_cast<int>(i)));
+            small.PushBack(NothrowMoveObj(static_cast<int>(i)));
+        }
+        assert(v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        assert(small[SIZE - 1].id == static_cast<int>(SIZE - 1));
+    }
+}
+
+void Test35() {
+    {
+        // Отрезок переноса — два элемента: перенос растягивается на много добавлений
+        IncrementalVector<std::string, std::allocator<std::string>, sizeof(std::string) * 2> v;
+        std::vector<std::string> expected;
+        bool was_migrating = false;
+        for (int i = 0; i < 10000; ++i) {
+            v.PushBack(std::to_string(i));
+            expected.push_back(std::to_string(i));
+            was_migrating = was_migrating || v.IsMigrating();
+            if (i % 997 == 0) {
+                assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+            }
+        }
+        assert(was_migrating);
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+        // Копия и удаление с конца посреди переноса
+        while (!v.IsMigrating()) {
+            v.PushBack(v[v.Size() / 2]);
+            expected.push_back(expected[expected.size() / 2]);
+        }
+        const auto copy = v;
+        assert(!copy.IsMigrating() && std::equal(copy.begin(), copy.end(), expected.begin(), expected.end()));
+        while (v.IsMigrating()) {
+            v.PopBack();
+            expected.pop_back();
+        }
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        v.Reserve(v.Capacity() * 2);
+        v.PushBack("last");
+        assert(v[v.Size() - 1] == "last" && !v.IsMigrating());
+    }
+    {
+        // Перенос вручную, например между запросами
+        IncrementalVector<int, std::allocator<int>, 64> v(1000);
+        std::iota(v.begin(), v.end(), 0);
+        v.PushBack(1000);
+        assert(v.IsMigrating() && v.Capacity() == 2000);
+        assert(v.Migrate(100) == 1000 - 16 - 100);
+        assert(v[500] == 500 && v[1000] == 1000);
+        v.FinishMigration();
+        assert(!v.IsMigrating() && v.Migrate(1) == 0);
+        for (int i = 0; i < 1001; ++i) {
+            assert(v[i] == i);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        {
+            IncrementalVector<Obj, std::allocator<Obj>, sizeof(Obj)> v;
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(v.IsMigrating());
+            IncrementalVector<Obj, std::allocator<Obj>, sizeof(Obj)> moved = std::move(v);
+            assert(v.Size() == 0 && moved.Size() == 100 && moved[99].id == 99);
+            v = moved;
+            moved.Clear();
+            assert(v[42].id == 42 && !moved.IsMigrating());
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
     }
 }
 
@@ -647,7 +2624,35 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,315 @@
+#pragma once
+#include "thread_pool.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Параллельные алгоритмы над Vector. Работают прямо с буфером [begin(), end()) и выполняются
+// в ThreadPool::Default(): диапазон делится на отрезки не короче policy.min_chunk_size,
+// отрезков больше, чем потоков, и освободившиеся потоки забирают чужие отрезки.
+// policy.num_threads ограничивает число потоков (0 — все потоки пула).
+// Функции, переданные алгоритмам, вызываются одновременно из нескольких потоков.
+
+namespace detail {
+
+// Отрезков на поток: запас для перераспределения работы между потоками
+inline constexpr size_t CHUNKS_PER_THREAD = 4;
+
+inline size_t NumChunks(size_t n, const ParallelPolicy& policy, size_t chunks_per_thread) {
+    const size_t pool_threads = ThreadPool::Default().NumThreads();
+    const size_t threads = policy.num_threads != 0 ? std::min(policy.num_threads, pool_threads) : pool_threads;
+    return std::clamp<size_t>(n / std::max<size_t>(policy.min_chunk_size, 1), 1, threads * chunks_per_thread);
+}
+
+inline size_t ChunkBound(size_t n, size_t num_chunks, size_t chunk) noexcept {
+    return n / num_chunks * chunk + std::min(chunk, n % num_chunks);
+}
+
+// Выполняет op(first, last) для отрезков [0, n) в пуле
+template <typename Op>
+void ParallelChunks(size_t n, const ParallelPolicy& policy, size_t chunks_per_thread, Op op) {
+    const size_t num_chunks = NumChunks(n, policy, chunks_per_thread);
+    ThreadPool::Default().Run(num_chunks, policy.num_threads, [n, num_chunks, &op](size_t chunk) {
+        op(ChunkBound(n, num_chunks, chunk), ChunkBound(n, num_chunks, chunk + 1));
+    });
+}
+
+// Целые ключи, упорядоченные по возрастанию, сортируются поразрядно
+template <typename T, typename Compare>
+inline constexpr bool RADIX_SORTABLE = std::is_integral_v<T> && !std::is_same_v<T, bool>
+    && (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>);
+
+// Поразрядная сортировка LSD по байтам. На каждом проходе отрезки считают гистограммы цифр,
+// из них получаются смещения каждого отрезка для каждой цифры, и отрезки параллельно
+// раскладывают элементы в другой буфер. Проход, в котором у всех элементов одна цифра, пропускается.
+template <typename T, typename Alloc>
+void ParallelRadixSort(T* data, size_t n, const Alloc& alloc, const ParallelPolicy& policy) {
+    using Key = std::make_unsigned_t<T>;
+    constexpr size_t RADIX_BITS = 8;
+    constexpr size_t RADIX = size_t{1} << RADIX_BITS;
+    // Инверсия старшего бита ставит отрицательные числа раньше положительных
+    constexpr Key SIGN_FLIP = std::is_signed_v<T> ? static_cast<Key>(Key{1} << (sizeof(T) * 8 - 1)) : Key{0};
+
+    if (n <= RADIX) {
+        std::sort(data, data + n);
+        return;
+    }
+    const size_t num_chunks = NumChunks(n, policy, 1);
+    RawMemory<T, Alloc> scratch(n, alloc);
+    Vector<size_t> offsets(num_chunks * RADIX);
+    T* from = data;
+    T* to = scratch.GetAddress();
+    for (size_t shift = 0; shift < sizeof(T) * 8; shift += RADIX_BITS) {
+        const auto digit = [shift](T value) noexcept {
+            return static_cast<size_t>(static_cast<Key>(static_cast<Key>(value) ^ SIGN_FLIP) >> shift) & (RADIX - 1);
+        };
+        ThreadPool::Default().Run(num_chunks, policy.num_threads, [&](size_t chunk) {
+            size_t* counts = offsets.begin() + chunk * RADIX;
+            std::fill_n(counts, RADIX, 0);
+            for (size_t i = ChunkBound(n, num_chunks, chunk); i < ChunkBound(n, num_chunks, chunk + 1); ++i) {
+                ++counts[digit(from[i])];
+            }
+        });
+
+        // Элементы отрезка с цифрой d идут после всех элементов с меньшими цифрами
+        // и после элементов с цифрой d из предыдущих отрезков, поэтому сортировка устойчива
+        size_t total = 0;
+        bool single_digit = false;
+        for (size_t d = 0; d < RADIX; ++d) {
+            const size_t digit_start = total;
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                const size_t count = std::exchange(offsets[chunk * RADIX + d], total);
+                total += count;
+            }
+            single_digit = single_digit || total - digit_start == n;
+        }
+        if (single_digit) {
+            continue;
+        }
+
+        ThreadPool::Default().Run(num_chunks, policy.num_threads, [&](size_t chunk) {
+            size_t* next = offsets.begin() + chunk * RADIX;
+            for (size_t i = ChunkBound(n, num_chunks, chunk); i < ChunkBound(n, num_chunks, chunk + 1); ++i) {
+                to[next[digit(from[i])]++] = from[i];
+            }
+        });
+        std::swap(from, to);
+    }
+    if (from != data) {
+        ParallelChunks(n, policy, 1, [from, data](size_t first, size_t last) {
+            std::memcpy(data + first, from + first, (last - first) * sizeof(T));
+        });
+    }
+}
+
+// Слияние отрезков [a_first, a_last) и [b_first, b_last) в out
+template <typename T>
+struct MergeTask {
+    T* a_first;
+    T* a_last;
+    T* b_first;
+    T* b_last;
+    T* out;
+};
+
+// Сколько элементов a попадёт в первые count элементов устойчивого слияния a и b
+template <typename T, typename Compare>
+size_t MergePathSplit(const T* a, size_t a_size, const T* b, size_t b_size, size_t count, Compare& comp) {
+    size_t low = count > b_size ? count - b_size : 0;
+    size_t high = std::min(count, a_size);
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (comp(b[count - mid - 1], a[mid])) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+// Слияние пары отрезков делится по выходу на части по piece элементов, чтобы
+// последние проходы с немногими длинными отрезками тоже занимали все потоки
+template <typename T, typename Compare>
+void AddMergeTasks(Vector<MergeTask<T>>& tasks, T* a, size_t a_size, T* b, size_t b_size, T* out, size_t piece,
+                   Compare& comp) {
+    size_t a_done = 0;
+    size_t b_done = 0;
+    for (size_t done = 0; done < a_size + b_size;) {
+        const size_t next = std::min(done + piece, a_size + b_size);
+        const size_t a_next = MergePathSplit(a, a_size, b, b_size, next, comp);
+        const size_t b_next = next - a_next;
+        tasks.PushBack({a + a_done, a + a_next, b + b_done, b + b_next, out + done});
+        a_done = a_next;
+        b_done = b_next;
+        done = next;
+    }
+}
+
+// Сортирует отрезки параллельно, а затем попарно сливает их, перекладывая элементы
+// между вектором и буфером RawMemory того же аллокатора
+template <typename T, typename Compare, typename Alloc>
+void ParallelMergeSort(T* data, size_t n, Compare& comp, const Alloc& alloc, const ParallelPolicy& policy) {
+    const size_t num_runs = NumChunks(n, policy, 1);
+    if (num_runs == 1) {
+        std::sort(data, data + n, comp);
+        return;
+    }
+    // Слияние присваивает элементы, поэтому для нетривиальных типов в буфере создаются объекты:
+    // элементы переносятся в буфер, а в векторе остаются перемещённые объекты
+    constexpr bool CONSTRUCTS_SCRATCH = !std::is_trivially_copyable_v<T>;
+    RawMemory<T, Alloc> scratch(n, alloc);
+    T* from = data;
+    T* to = scratch.GetAddress();
+    if constexpr (CONSTRUCTS_SCRATCH) {
+        if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            ParallelChunks(n, policy, 1, [data, to](size_t first, size_t last) noexcept {
+                std::uninitialized_move_n(data + first, last - first, to + first);
+            });
+        } else {
+            std::uninitialized_move_n(data, n, to);
+        }
+        std::swap(from, to);
+    }
+
+    try {
+        ThreadPool::Default().Run(num_runs, policy.num_threads, [from, n, num_runs, &comp](size_t run) {
+            std::sort(from + ChunkBound(n, num_runs, run), from + ChunkBound(n, num_runs, run + 1), comp);
+        });
+        Vector<size_t> bounds;
+        for (size_t run = 0; run <= num_runs; ++run) {
+            bounds.PushBack(ChunkBound(n, num_runs, run));
+        }
+        const size_t piece = std::max<size_t>(policy.min_chunk_size, n / NumChunks(n, policy, CHUNKS_PER_THREAD));
+        while (bounds.Size() > 2) {
+            Vector<MergeTask<T>> tasks;
+            Vector<size_t> merged_bounds;
+            for (size_t run = 0; run + 1 < bounds.Size(); run += 2) {
+                const size_t a = bounds[run];
+                const size_t b = bounds[run + 1];
+                // У последнего отрезка без пары вторая половина пуста
+                const size_t b_end = run + 2 < bounds.Size() ? bounds[run + 2] : b;
+                AddMergeTasks(tasks, from + a, b - a, from + b, b_end - b, to + a, piece, comp);
+                merged_bounds.PushBack(a);
+            }
+            merged_bounds.PushBack(n);
+            ThreadPool::Default().Run(tasks.Size(), policy.num_threads, [&tasks, &comp](size_t task) {
+                const MergeTask<T>& t = tasks[task];
+                std::merge(std::make_move_iterator(t.a_first), std::make_move_iterator(t.a_last),
+                           std::make_move_iterator(t.b_first), std::make_move_iterator(t.b_last), t.out, comp);
+            });
+            bounds = std::move(merged_bounds);
+            std::swap(from, to);
+        }
+        if (from != data) {
+            ParallelChunks(n, policy, CHUNKS_PER_THREAD, [from, data](size_t first, size_t last) {
+                std::move(from + first, from + last, data + first);
+            });
+        }
+    } catch (...) {
+        if constexpr (CONSTRUCTS_SCRATCH) {
+            std::destroy_n(scratch.GetAddress(), n);
+        }
+        throw;
+    }
+    if constexpr (CONSTRUCTS_SCRATCH) {
+        ParallelChunks(n, policy, 1, [&scratch](size_t first, size_t last) noexcept {
+            std::destroy_n(scratch.GetAddress() + first, last - first);
+        });
+    }
+}
+
+}  // namespace detail
+
+// Вызывает f(element) для каждого элемента в неопределённом порядке
+template <typename T, typename Alloc, typename Growth, typename Stats, typename F>
+void ParallelForEach(Vector<T, Alloc, Growth, Stats>& v, F f, const ParallelPolicy& policy = PARALLEL) {
+    T* const data = v.begin();
+    detail::ParallelChunks(v.Size(), policy, detail::CHUNKS_PER_THREAD, [data, &f](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            f(data[i]);
+        }
+    });
+}
+
+// Заменяет каждый элемент результатом op(element)
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Op>
+void ParallelTransform(Vector<T, Alloc, Growth, Stats>& v, Op op, const ParallelPolicy& policy = PARALLEL) {
+    T* const data = v.begin();
+    detail::ParallelChunks(v.Size(), policy, detail::CHUNKS_PER_THREAD, [data, &op](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            data[i] = op(data[i]);
+        }
+    });
+}
+
+// Делает out вектором результатов op для элементов in. Новые элементы out создаются
+// инициализацией по умолчанию, поэтому страницы буфера первыми касаются рабочие потоки.
+template <typename T, typename Alloc, typename Growth, typename Stats, typename U, typename OutAlloc,
+          typename OutGrowth, typename OutStats, typename Op>
+void ParallelTransform(const Vector<T, Alloc, Growth, Stats>& in, Vector<U, OutAlloc, OutGrowth, OutStats>& out, Op op,
+                       const ParallelPolicy& policy = PARALLEL) {
+    out.ResizeDefaultInit(in.Size());
+    const T* const from = in.begin();
+    U* const to = out.begin();
+    detail::ParallelChunks(in.Size(), policy, detail::CHUNKS_PER_THREAD, [from, to, &op](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            to[i] = op(from[i]);
+        }
+    });
+}
+
+// Сворачивает элементы операцией op, которая должна быть ассоциативной. Порядок аргументов
+// сохраняется: отрезки сворачиваются параллельно, начиная со своего первого элемента
+// (R должен создаваться из T), а их результаты — слева направо после init.
+template <typename T, typename Alloc, typename Growth, typename Stats, typename R, typename Op>
+R ParallelReduce(const Vector<T, Alloc, Growth, Stats>& v, R init, Op op, const ParallelPolicy& policy = PARALLEL) {
+    const size_t n = v.Size();
+    const size_t num_chunks = detail::NumChunks(n, policy, detail::CHUNKS_PER_THREAD);
+    const T* const data = v.begin();
+    if (num_chunks == 1) {
+        for (size_t i = 0; i < n; ++i) {
+            init = op(std::move(init), data[i]);
+        }
+        return init;
+    }
+    Vector<std::optional<R>> partial(num_chunks);
+    ThreadPool::Default().Run(num_chunks, policy.num_threads, [&](size_t chunk) {
+        const size_t first = detail::ChunkBound(n, num_chunks, chunk);
+        const size_t last = detail::ChunkBound(n, num_chunks, chunk + 1);
+        R result(data[first]);
+        for (size_t i = first + 1; i < last; ++i) {
+            result = op(std::move(result), data[i]);
+        }
+        partial[chunk].emplace(std::move(result));
+    });
+    for (std::optional<R>& result : partial) {
+        init = op(std::move(init), std::move(*result));
+    }
+    return init;
+}
+
+// Сортирует элементы по comp. Целые числа с std::less сортируются поразрядно, остальные —
+// слиянием параллельно отсортированных отрезков. Порядок равных элементов не сохраняется.
+// Если comp бросил исключение, вектор остаётся корректным, но значения элементов не определены.
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Compare>
+void ParallelSort(Vector<T, Alloc, Growth, Stats>& v, Compare comp, const ParallelPolicy& policy = PARALLEL) {
+    if constexpr (detail::RADIX_SORTABLE<T, Compare>) {
+        detail::ParallelRadixSort(v.begin(), v.Size(), v.GetAllocator(), policy);
+    } else {
+        detail::ParallelMergeSort(v.begin(), v.Size(), comp, v.GetAllocator(), policy);
+    }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats>
+void ParallelSort(Vector<T, Alloc, Growth, Stats>& v, const ParallelPolicy& policy = PARALLEL) {
+    ParallelSort(v, std::less<>{}, policy);
+}
@@ -0,0 +1,300 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class PersistentMode {
+    // Только чтение существующего файла. Страницы разделяются всеми процессами, открывшими файл.
+    // Отображение защищено от записи, поэтому элементы читаются только через const-методы.
+    READ_ONLY,
+    // Чтение и запись; отсутствующий файл создаётся
+    READ_WRITE,
+    // Как READ_WRITE, но существующее содержимое удаляется
+    TRUNCATE,
+};
+
+// Заголовок файла PersistentVector. Файл переносим только между процессами одной архитектуры.
+struct PersistentHeader {
+    static constexpr uint64_t MAGIC = 0x31524f5443455641;  // "AVECTOR1"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    uint64_t magic = MAGIC;
+    uint32_t format_version = FORMAT_VERSION;
+    // Версия раскладки элемента, которую задаёт пользователь при изменении T
+    uint32_t layout_version = 0;
+    uint64_t element_size = 0;
+    uint64_t element_alignment = 0;
+    uint64_t size = 0;
+    uint64_t capacity = 0;
+};
+
+// Вектор, элементы которого живут в отображённом в память файле. Повторное открытие
+// занимает постоянное время: данные не десериализуются, страницы подгружаются по мере чтения.
+// Размер хранится в заголовке файла и обновляется каждой операцией, поэтому файл всегда
+// описывает созданный префикс элементов. Рост увеличивает файл через ftruncate и отображение
+// через mremap. Flush сбрасывает изменения на диск; без него это сделает ядро позже.
+// Одновременно писать в файл может только один процесс; читать — любое число.
+// Неконстантные методы, включая operator[], begin() и end(), открытому только для чтения
+// вектору вызывать нельзя (проверяется assert). Перемещённый вектор пуст и без отображения.
+template <typename T, uint32_t LayoutVersion = 0, typename Growth = DoublingGrowth<>>
+class PersistentVector {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be stored in a file");
+
+    // Элементы начинаются с выровненного смещения после заголовка
+    static constexpr size_t DATA_OFFSET = 64;
+    static_assert(sizeof(PersistentHeader) <= DATA_OFFSET && alignof(T) <= DATA_OFFSET,
+                  "Element alignment is too large");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    PersistentVector(const std::filesystem::path& path, PersistentMode mode)
+        : read_only_(mode == PersistentMode::READ_ONLY) {
+        int flags = O_CLOEXEC | (read_only_ ? O_RDONLY : O_RDWR | O_CREAT);
+        if (mode == PersistentMode::TRUNCATE) {
+            flags |= O_TRUNC;
+        }
+        fd_ = open(path.c_str(), flags, 0644);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), path.string());
+        }
+        try {
+            Open(path);
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    PersistentVector(PersistentVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , mapping_(std::exchange(other.mapping_, nullptr))
+        , mapped_bytes_(std::exchange(other.mapped_bytes_, 0))
+        , read_only_(other.read_only_) {
+    }
+
+    PersistentVector& operator=(PersistentVector&& rhs) noexcept {
+        std::swap(fd_, rhs.fd_);
+        std::swap(mapping_, rhs.mapping_);
+        std::swap(mapped_bytes_, rhs.mapped_bytes_);
+        std::swap(read_only_, rhs.read_only_);
+        return *this;
+    }
+
+    PersistentVector(const PersistentVector&) = delete;
+    PersistentVector& operator=(const PersistentVector&) = delete;
+
+    ~PersistentVector() {
+        Close();
+    }
+
+    size_t Size() const noexcept {
+        return mapping_ != nullptr ? static_cast<size_t>(Header()->size) : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return mapping_ != nullptr ? static_cast<size_t>(Header()->capacity) : 0;
+    }
+
+    bool IsReadOnly() const noexcept {
+        return read_only_;
+    }
+
+    // Увеличивает файл и отображение. При исключении вектор не изменяется.
+    void Reserve(size_t new_capacity) {
+        assert(!read_only_);
+        if (new_capacity <= Capacity()) return;
+
+        const size_t new_bytes = DATA_OFFSET + new_capacity * sizeof(T);
+        if (ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+            throw std::system_error(errno, std::generic_category(), "ftruncate");
+        }
+        void* new_mapping = mremap(mapping_, mapped_bytes_, new_bytes, MREMAP_MAYMOVE);
+        if (new_mapping == MAP_FAILED) {
+            const int error = errno;
+            // Возвращаем файлу прежний размер; если не выйдет, лишний хвост файла безвреден
+            [[maybe_unused]] const int result = ftruncate(fd_, static_cast<off_t>(mapped_bytes_));
+            throw std::system_error(error, std::generic_category(), "mremap");
+        }
+        mapping_ = new_mapping;
+        mapped_bytes_ = new_bytes;
+        Header()->capacity = new_capacity;
+    }
+
+    // У перемещённого вектора нет заголовка: Resize(0) и Clear ничего не делают
+    void Resize(size_t new_size) {
+        assert(!read_only_);
+        if (mapping_ == nullptr && new_size == 0) return;
+        Reserve(new_size);
+        if (new_size > Size()) {
+            std::uninitialized_value_construct_n(Data() + Size(), new_size - Size());
+        }
+        Header()->size = new_size;
+    }
+
+    void Clear() noexcept {
+        assert(!read_only_);
+        if (mapping_ == nullptr) return;
+        Header()->size = 0;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        assert(!read_only_);
+        if (Size() == Capacity()) {
+            // Аргументы могут ссылаться на элементы, которые переедут при mremap
+            T value(std::forward<Args>(args)...);
+            Reserve(Growth::template NextCapacity<T>(Capacity()));
+            return PlaceBack(value);
+        }
+        return PlaceBack(T(std::forward<Args>(args)...));
+    }
+
+    void PopBack() noexcept {
+        assert(!read_only_ && Size() > 0);
+        --Header()->size;
+    }
+
+    // Синхронно записывает изменения на диск
+    void Flush() {
+        if (!read_only_ && mapping_ != nullptr && msync(mapping_, mapped_bytes_, MS_SYNC) != 0) {
+            throw std::system_error(errno, std::generic_category(), "msync");
+        }
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(!read_only_ && index < Size());
+        return Data()[index];
+    }
+
+    iterator begin() noexcept {
+        assert(!read_only_);
+        return Data();
+    }
+
+    iterator end() noexcept {
+        assert(!read_only_);
+        return Data() + Size();
+    }
+
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+
+    const_iterator end() const noexcept {
+        return Data() + Size();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    void Open(const std::filesystem::path& path) {
+        struct stat file_stat {};
+        if (fstat(fd_, &file_stat) != 0) {
+            throw std::system_error(errno, std::generic_category(), path.string());
+        }
+        const bool is_new = file_stat.st_size == 0;
+        if (is_new) {
+            if (read_only_) {
+                throw std::runtime_error(path.string() + ": not a persistent vector");
+            }
+            if (ftruncate(fd_, DATA_OFFSET) != 0) {
+                throw std::system_error(errno, std::generic_category(), path.string());
+            }
+        }
+        const size_t file_bytes = is_new ? DATA_OFFSET : static_cast<size_t>(file_stat.st_size);
+        if (file_bytes < DATA_OFFSET) {
+            throw std::runtime_error(path.string() + ": not a persistent vector");
+        }
+        const int protection = read_only_ ? PROT_READ : PROT_READ | PROT_WRITE;
+        void* mapping = mmap(nullptr, file_bytes, protection, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), path.string());
+        }
+        mapping_ = mapping;
+        mapped_bytes_ = file_bytes;
+
+        if (is_new) {
+            PersistentHeader header;
+            header.layout_version = LayoutVersion;
+            header.element_size = sizeof(T);
+            header.element_alignment = alignof(T);
+            std::construct_at(static_cast<PersistentHeader*>(mapping_), header);
+            return;
+        }
+        const PersistentHeader& header = *Header();
+        if (header.magic != PersistentHeader::MAGIC || header.format_version != PersistentHeader::FORMAT_VERSION) {
+            throw std::runtime_error(path.string() + ": not a persistent vector");
+        }
+        if (header.layout_version != LayoutVersion || header.element_size != sizeof(T)
+            || header.element_alignment != alignof(T)) {
+            throw std::runtime_error(path.string() + ": element layout mismatch");
+        }
+        if (header.size > header.capacity || (file_bytes - DATA_OFFSET) / sizeof(T) < header.capacity) {
+            throw std::runtime_error(path.string() + ": file is truncated");
+        }
+    }
+
+    void Close() noexcept {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, mapped_bytes_);
+            mapping_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    T& PlaceBack(const T& value) noexcept {
+        T* place = std::construct_at(Data() + Size(), value);
+        ++Header()->size;
+        return *place;
+    }
+
+    PersistentHeader* Header() const noexcept {
+        return static_cast<PersistentHeader*>(mapping_);
+    }
+
+    T* Data() const noexcept {
+        return mapping_ != nullptr ? reinterpret_cast<T*>(static_cast<std::byte*>(mapping_) + DATA_OFFSET) : nullptr;
+    }
+
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    bool read_only_ = false;
+};
+
+#endif  // __linux__
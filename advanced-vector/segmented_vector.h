@@ -0,0 +1,318 @@
+#pragma once
+#include "segments.h"
+#include "vector.h"
+
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Вектор из сегментов RawMemory геометрически растущего размера: сегмент k вмещает
+// FirstSegmentSize << k элементов. При росте выделяется очередной сегмент, а существующие
+// элементы не перемещаются и не копируются, поэтому указатели и ссылки на них остаются
+// действительными до удаления самих элементов, и тип может не иметь noexcept-перемещения.
+// Доступ по индексу — O(1): номер сегмента вычисляется по старшему биту индекса.
+// Для быстрого обхода есть ForEachSegment, отдающий элементы непрерывными отрезками.
+template <typename T, size_t FirstSegmentSize = 16>
+class SegmentedVector {
+    using Segments = detail::GeometricSegments<FirstSegmentSize>;
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner), index_(index) {
+            Locate();
+        }
+
+        operator BasicIterator<true>() const noexcept
+            requires(!IsConst)
+        {
+            return BasicIterator<true>(owner_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return *ptr_;
+        }
+
+        pointer operator->() const noexcept {
+            return ptr_;
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return *(*this + offset);
+        }
+
+        // Внутри сегмента переход к следующему элементу — инкремент указателя
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            if (++ptr_ == segment_end_) {
+                Locate();
+            }
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy(*this);
+            ++*this;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            Locate();
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy(*this);
+            --*this;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            Locate();
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            return *this += -offset;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend std::strong_ordering operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        void Locate() noexcept {
+            const size_t segment = Segments::SegmentOf(index_);
+            if (segment < owner_->num_segments_) {
+                pointer begin = owner_->segments_[segment].GetAddress();
+                ptr_ = begin + Segments::OffsetOf(index_, segment);
+                segment_end_ = begin + Segments::SegmentSize(segment);
+            } else {
+                ptr_ = nullptr;
+                segment_end_ = nullptr;
+            }
+        }
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+        pointer ptr_ = nullptr;
+        pointer segment_end_ = nullptr;
+    };
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SegmentedVector() noexcept = default;
+
+    explicit SegmentedVector(size_t size) {
+        Reserve(size);
+        try {
+            for (size_t i = 0; i < size; ++i) {
+                EmplaceBack();
+            }
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other) {
+        Reserve(other.size_);
+        try {
+            other.ForEachSegment([this](std::span<const T> elements) {
+                for (const T& value : elements) {
+                    EmplaceBack(value);
+                }
+            });
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept {
+        Swap(other);
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    // Выделяет сегменты так, чтобы вместить capacity элементов
+    void Reserve(size_t capacity) {
+        while (Capacity() < capacity) {
+            AddSegment();
+        }
+    }
+
+    // Уничтожает элементы, сохраняя выделенные сегменты
+    void Clear() noexcept {
+        ForEachSegment([](std::span<T> elements) {
+            std::destroy(elements.begin(), elements.end());
+        });
+        size_ = 0;
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        for (size_t segment = 0; segment < std::max(num_segments_, other.num_segments_); ++segment) {
+            segments_[segment].Swap(other.segments_[segment]);
+        }
+        std::swap(num_segments_, other.num_segments_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return Segments::SegmentStart(num_segments_);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        const size_t segment = Segments::SegmentOf(index);
+        return segments_[segment][Segments::OffsetOf(index, segment)];
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Никогда не перемещает существующие элементы. Если конструктор бросил исключение,
+    // вектор не изменяется (новый сегмент остаётся выделенным).
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            AddSegment();
+        }
+        const size_t segment = Segments::SegmentOf(size_);
+        T* place = std::construct_at(segments_[segment] + Segments::OffsetOf(size_, segment),
+                                     std::forward<Args>(args)...);
+        ++size_;
+        return *place;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        const size_t segment = Segments::SegmentOf(size_);
+        std::destroy_at(segments_[segment] + Segments::OffsetOf(size_, segment));
+    }
+
+    // Вызывает f(std::span<T>) для каждого непустого отрезка элементов по порядку.
+    // Внутренний цикл по span компилятор может векторизовать, в отличие от обхода итераторами.
+    template <typename F>
+    void ForEachSegment(F&& f) {
+        for (size_t segment = 0; segment < num_segments_ && Segments::SegmentStart(segment) < size_; ++segment) {
+            const size_t count = std::min(Segments::SegmentSize(segment), size_ - Segments::SegmentStart(segment));
+            f(std::span<T>(segments_[segment].GetAddress(), count));
+        }
+    }
+
+    template <typename F>
+    void ForEachSegment(F&& f) const {
+        const_cast<SegmentedVector&>(*this).ForEachSegment([&f](std::span<T> elements) {
+            f(std::span<const T>(elements));
+        });
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    void AddSegment() {
+        assert(num_segments_ < Segments::MAX_SEGMENTS);
+        RawMemory<T> segment(Segments::SegmentSize(num_segments_));
+        segments_[num_segments_].Swap(segment);
+        ++num_segments_;
+    }
+
+    RawMemory<T> segments_[Segments::MAX_SEGMENTS];
+    size_t num_segments_ = 0;
+    size_t size_ = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+
+namespace detail {
+
+// Разбиение индексов на сегменты геометрически растущего размера: сегмент k содержит
+// First << k элементов, где First — степень двойки. Сегменты 0..k-1 вместе содержат
+// First * (2^k - 1) элементов, поэтому сегмент элемента index определяется старшим
+// битом числа index + First, а смещение в сегменте — остальными битами.
+template <size_t First>
+struct GeometricSegments {
+    static_assert(std::has_single_bit(First), "First segment size must be a power of two");
+
+    static constexpr size_t FIRST_LOG2 = std::countr_zero(First);
+    // Число сегментов, достаточное для любого индекса типа size_t
+    static constexpr size_t MAX_SEGMENTS = sizeof(size_t) * 8 - FIRST_LOG2;
+
+    static constexpr size_t SegmentOf(size_t index) noexcept {
+        // "| First" не меняет результат, но сообщает компилятору, что сегмент не отрицателен
+        return std::bit_width((index + First) | First) - 1 - FIRST_LOG2;
+    }
+
+    static constexpr size_t OffsetOf(size_t index, size_t segment) noexcept {
+        return index + First - (First << segment);
+    }
+
+    static constexpr size_t SegmentSize(size_t segment) noexcept {
+        return First << segment;
+    }
+
+    // Индекс первого элемента сегмента
+    static constexpr size_t SegmentStart(size_t segment) noexcept {
+        return (First << segment) - First;
+    }
+};
+
+}  // namespace detail
@@ -0,0 +1,264 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Вектор, хранящий до N элементов внутри себя. При росте сверх N элементы
+// переносятся в динамическую память RawMemory. Интерфейс совпадает с Vector.
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "Inline capacity must be positive");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() noexcept = default;
+
+    explicit SmallVector(size_t size) {
+        Reserve(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other) {
+        Reserve(other.size_);
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        TakeElements(other);
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            if (rhs.size_ > Capacity()) {
+                SmallVector tmp(rhs);
+                Swap(tmp);
+            } else {
+                std::copy_n(rhs.Data(), std::min(size_, rhs.size_), Data());
+                if (size_ < rhs.size_) {
+                    std::uninitialized_copy_n(rhs.Data() + size_, rhs.size_ - size_, Data() + size_);
+                } else if (size_ > rhs.size_) {
+                    std::destroy_n(Data() + rhs.size_, size_ - rhs.size_);
+                }
+                size_ = rhs.size_;
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            std::destroy_n(Data(), size_);
+            size_ = 0;
+            TakeElements(rhs);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) return;
+
+        RawMemory<T> new_data(new_capacity);
+        detail::UninitializedRelocateN(Data(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    // Элементы, хранящиеся внутри объекта, нельзя обменять указателями,
+    // поэтому в общем случае обмен выполняется через перемещения
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы хранятся во встроенном буфере
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        } else {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(Data() + --size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            return *EmplaceWithRealloc(size_, std::forward<Args>(args)...);
+        }
+        T* place = std::construct_at(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return *place;
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        size_t index = pos - begin();
+        return size_ == Capacity()
+            ? EmplaceWithRealloc(index, std::forward<Args>(args)...)
+            : EmplaceWithoutRealloc(index, std::forward<Args>(args)...);
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= begin() && pos < end());
+        T* mutable_pos = Data() + (pos - begin());
+        std::move(mutable_pos + 1, Data() + size_, mutable_pos);
+        std::destroy_at(Data() + --size_);
+        return mutable_pos;
+    }
+
+private:
+    T* Data() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    // Забирает элементы other: буфер в куче передаётся целиком, встроенные элементы перемещаются
+    void TakeElements(SmallVector& other) {
+        if (!other.IsInline()) {
+            heap_.Swap(other.heap_);
+        } else {
+            std::uninitialized_move_n(other.Data(), other.size_, Data());
+            std::destroy_n(other.Data(), other.size_);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    template <typename... Args>
+    iterator EmplaceWithRealloc(size_t index, Args&&... args) {
+        RawMemory<T> new_data(Capacity() * 2);
+        T* new_pos = new_data.GetAddress() + index;
+        std::construct_at(new_pos, std::forward<Args>(args)...);
+
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            detail::UninitializedRelocateN(Data(), index, new_data.GetAddress());
+            detail::UninitializedRelocateN(Data() + index, size_ - index, new_pos + 1);
+        } else {
+            try {
+                detail::UninitializedMoveOrCopyN(Data(), index, new_data.GetAddress());
+            } catch (...) {
+                std::destroy_at(new_pos);
+                throw;
+            }
+            try {
+                detail::UninitializedMoveOrCopyN(Data() + index, size_ - index, new_pos + 1);
+            } catch (...) {
+                std::destroy_n(new_data.GetAddress(), index + 1);
+                throw;
+            }
+            std::destroy_n(Data(), size_);
+        }
+
+        heap_.Swap(new_data);
+        ++size_;
+        return new_pos;
+    }
+
+    template <typename... Args>
+    iterator EmplaceWithoutRealloc(size_t index, Args&&... args) {
+        T* pos_ptr = Data() + index;
+
+        if (index < size_) {
+            T temp(std::forward<Args>(args)...);
+            std::construct_at(Data() + size_, std::move(Data()[size_ - 1]));
+            std::move_backward(pos_ptr, Data() + size_ - 1, Data() + size_);
+            *pos_ptr = std::move(temp);
+        } else {
+            std::construct_at(pos_ptr, std::forward<Args>(args)...);
+        }
+
+        ++size_;
+        return pos_ptr;
+    }
+
+    alignas(T) std::byte inline_[sizeof(T) * N];
+    RawMemory<T> heap_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,276 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Вектор записей, каждое поле которых хранится в отдельном столбце RawMemory
+// (структура массивов). Циклы, читающие несколько полей, загружают в кэш только их.
+// Все столбцы имеют общие размер и ёмкость и растут вместе с теми же гарантиями
+// безопасности исключений, что и Vector. Строка доступна как кортеж ссылок на поля,
+// столбец — как std::span, пригодный для векторизованных ядер.
+template <typename... Fields>
+class SoaVector {
+    static_assert(sizeof...(Fields) > 0, "SoaVector needs at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    // Перенос столбца может бросить исключение: копированием или, при CopyFallback::MOVE
+    // и у типов без копирования, перемещением без noexcept
+    template <size_t I>
+    static constexpr bool MAY_THROW_ON_RELOCATION = !IsTriviallyRelocatableV<Field<I>>
+        && !std::is_nothrow_move_constructible_v<Field<I>>;
+
+public:
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+
+    SoaVector() noexcept = default;
+
+    explicit SoaVector(size_t size)
+        : columns_(RawMemory<Fields>(size)...) {
+        ForEachColumnWithRollback(
+            [this, size](auto column) {
+                std::uninitialized_value_construct_n(ColumnData<column>(), size);
+            },
+            [this, size](auto column) {
+                std::destroy_n(ColumnData<column>(), size);
+            });
+        size_ = size;
+    }
+
+    SoaVector(const SoaVector& other)
+        : columns_(RawMemory<Fields>(other.size_)...) {
+        ForEachColumnWithRollback(
+            [this, &other](auto column) {
+                std::uninitialized_copy_n(other.ColumnData<column>(), other.size_, ColumnData<column>());
+            },
+            [this, &other](auto column) {
+                std::destroy_n(ColumnData<column>(), other.size_);
+            });
+        size_ = other.size_;
+    }
+
+    SoaVector(SoaVector&& other) noexcept {
+        Swap(other);
+    }
+
+    SoaVector& operator=(const SoaVector& rhs) {
+        if (this != &rhs) {
+            SoaVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        Clear();
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        ForEachColumn([this, &other](auto column) {
+            std::get<column>(columns_).Swap(std::get<column>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    // Строгая гарантия безопасности исключений: если перенос любого столбца не удался,
+    // все столбцы остаются в прежних буферах
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) return;
+        Columns new_columns{RawMemory<Fields>(new_capacity)...};
+        RelocateTo(new_columns);
+        columns_.swap(new_columns);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            ForEachColumn([this, new_size](auto column) {
+                std::destroy_n(ColumnData<column>() + new_size, size_ - new_size);
+            });
+        } else if (new_size > size_) {
+            Reserve(new_size);
+            ForEachColumnWithRollback(
+                [this, new_size](auto column) {
+                    std::uninitialized_value_construct_n(ColumnData<column>() + size_, new_size - size_);
+                },
+                [this, new_size](auto column) {
+                    std::destroy_n(ColumnData<column>() + size_, new_size - size_);
+                });
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        ForEachColumn([this](auto column) {
+            std::destroy_n(ColumnData<column>(), size_);
+        });
+        size_ = 0;
+    }
+
+    // Добавляет строку; каждое поле создаётся из своего аргумента. Аргументы могут ссылаться
+    // на строки самого вектора. Строгая гарантия безопасности исключений.
+    template <typename... Args>
+    Row EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "One argument per field is required");
+        if (size_ == Capacity()) {
+            Columns new_columns{RawMemory<Fields>(size_ == 0 ? 1 : size_ * 2)...};
+            ConstructRow(new_columns, size_, std::forward<Args>(args)...);
+            try {
+                RelocateTo(new_columns);
+            } catch (...) {
+                ForEachColumn([this, &new_columns](auto column) {
+                    std::destroy_at(std::get<column>(new_columns).GetAddress() + size_);
+                });
+                throw;
+            }
+            columns_.swap(new_columns);
+        } else {
+            ConstructRow(columns_, size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const Fields&... values) {
+        EmplaceBack(values...);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        ForEachColumn([this](auto column) {
+            std::destroy_at(ColumnData<column>() + size_);
+        });
+    }
+
+    // Кортеж ссылок на поля строки; поддерживает структурное связывание и присваивание кортежа
+    Row operator[](size_t index) noexcept {
+        assert(index < size_);
+        return std::apply(
+            [index](RawMemory<Fields>&... columns) {
+                return Row(columns[index]...);
+            },
+            columns_);
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return std::apply(
+            [index](const RawMemory<Fields>&... columns) {
+                return ConstRow(columns.GetAddress()[index]...);
+            },
+            columns_);
+    }
+
+    template <size_t I>
+    std::span<Field<I>> Column() noexcept {
+        return {ColumnData<I>(), size_};
+    }
+
+    template <size_t I>
+    std::span<const Field<I>> Column() const noexcept {
+        return {ColumnData<I>(), size_};
+    }
+
+private:
+    template <size_t I>
+    Field<I>* ColumnData() noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    const Field<I>* ColumnData() const noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    // Вызывает f(std::integral_constant<size_t, I>) для каждого столбца I
+    template <typename F>
+    static void ForEachColumn(F&& f) {
+        [&f]<size_t... I>(std::index_sequence<I...>) {
+            (f(std::integral_constant<size_t, I>{}), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    // Вызывает construct для столбцов по порядку. Если construct для столбца бросил исключение,
+    // для уже обработанных столбцов вызывается destroy, и исключение пробрасывается дальше.
+    template <size_t I = 0, typename Construct, typename Destroy>
+    static void ForEachColumnWithRollback(Construct&& construct, Destroy&& destroy) {
+        if constexpr (I < sizeof...(Fields)) {
+            construct(std::integral_constant<size_t, I>{});
+            try {
+                ForEachColumnWithRollback<I + 1>(construct, destroy);
+            } catch (...) {
+                destroy(std::integral_constant<size_t, I>{});
+                throw;
+            }
+        }
+    }
+
+    template <typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&&... args) {
+        auto args_tuple = std::forward_as_tuple(std::forward<Args>(args)...);
+        ForEachColumnWithRollback(
+            [&](auto column) {
+                std::construct_at(std::get<column>(columns).GetAddress() + index,
+                                  std::get<column>(std::move(args_tuple)));
+            },
+            [&](auto column) {
+                std::destroy_at(std::get<column>(columns).GetAddress() + index);
+            });
+    }
+
+    // Переносит size_ строк в new_columns. Сначала создаются столбцы, перенос которых может
+    // бросить исключение, и только затем переносятся остальные: их перенос не бросает, поэтому
+    // исходные элементы не уничтожаются, пока не станет ясно, что перенос удался. Если
+    // бросающее перемещение (CopyFallback::MOVE) не удалось, часть исходных элементов
+    // остаётся в перемещённом состоянии, но все они живы (базовая гарантия).
+    void RelocateTo(Columns& new_columns) {
+        ForEachColumnWithRollback(
+            [this, &new_columns](auto column) {
+                if constexpr (MAY_THROW_ON_RELOCATION<column>) {
+                    detail::UninitializedMoveOrCopyN(ColumnData<column>(), size_,
+                                                     std::get<column>(new_columns).GetAddress());
+                }
+            },
+            [this, &new_columns](auto column) {
+                if constexpr (MAY_THROW_ON_RELOCATION<column>) {
+                    std::destroy_n(std::get<column>(new_columns).GetAddress(), size_);
+                }
+            });
+        ForEachColumn([this, &new_columns](auto column) {
+            if constexpr (MAY_THROW_ON_RELOCATION<column>) {
+                std::destroy_n(ColumnData<column>(), size_);
+            } else {
+                detail::UninitializedRelocateN(ColumnData<column>(), size_, std::get<column>(new_columns).GetAddress());
+            }
+        });
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,247 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Вектор ёмкостью не более N элементов, хранящихся внутри объекта. Память не выделяется
+// никогда, поэтому контейнер подходит для путей, где недопустим даже вызов аллокатора.
+// Интерфейс совпадает с Vector; превышение ёмкости — нарушение предусловия (проверяется assert),
+// а TryEmplaceBack сообщает о нехватке места, возвращая nullptr. Все операции constexpr.
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0, "Capacity must be positive");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr StaticVector() noexcept {
+    }
+
+    constexpr explicit StaticVector(size_t size) {
+        assert(size <= N);
+        detail::UninitializedValueConstructN(Data(), size);
+        size_ = size;
+    }
+
+    constexpr StaticVector(const StaticVector& other) {
+        detail::UninitializedCopyN(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    constexpr StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        TakeElements(other);
+    }
+
+    constexpr StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            std::copy_n(rhs.Data(), std::min(size_, rhs.size_), Data());
+            if (size_ < rhs.size_) {
+                detail::UninitializedCopyN(rhs.Data() + size_, rhs.size_ - size_, Data() + size_);
+            } else {
+                std::destroy_n(Data() + rhs.size_, size_ - rhs.size_);
+            }
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    constexpr StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            Clear();
+            TakeElements(rhs);
+        }
+        return *this;
+    }
+
+    // Для тривиально уничтожаемых T вектор сам тривиально уничтожаем
+    constexpr ~StaticVector() requires std::is_trivially_destructible_v<T> = default;
+
+    constexpr ~StaticVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    // Элементы хранятся внутри объектов, поэтому обмен выполняется поэлементно
+    constexpr void Swap(StaticVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                      && std::is_nothrow_swappable_v<T>) {
+        StaticVector& longer = size_ >= other.size_ ? *this : other;
+        StaticVector& shorter = size_ >= other.size_ ? other : *this;
+        std::swap_ranges(shorter.Data(), shorter.Data() + shorter.size_, longer.Data());
+        const size_t rest = longer.size_ - shorter.size_;
+        detail::UninitializedMoveN(longer.Data() + shorter.size_, rest, shorter.Data() + shorter.size_);
+        std::destroy_n(longer.Data() + shorter.size_, rest);
+        std::swap(size_, other.size_);
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    constexpr bool IsFull() const noexcept {
+        return size_ == N;
+    }
+
+    constexpr const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr void Resize(size_t new_size) {
+        assert(new_size <= N);
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        } else {
+            detail::UninitializedValueConstructN(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    constexpr void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    constexpr void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    constexpr void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(Data() + --size_);
+    }
+
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        assert(size_ < N);
+        T* place = std::construct_at(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return *place;
+    }
+
+    // Добавляет элемент, если есть место, и возвращает указатель на него, иначе nullptr
+    template <typename... Args>
+    constexpr T* TryEmplaceBack(Args&&... args) {
+        return size_ < N ? &EmplaceBack(std::forward<Args>(args)...) : nullptr;
+    }
+
+    constexpr iterator begin() noexcept {
+        return Data();
+    }
+
+    constexpr iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return Data();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return end();
+    }
+
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end() && size_ < N);
+        const size_t index = pos - begin();
+        T* pos_ptr = Data() + index;
+        if (index == size_) {
+            std::construct_at(pos_ptr, std::forward<Args>(args)...);
+        } else {
+            // Аргументы могут ссылаться на сдвигаемые элементы
+            T temp(std::forward<Args>(args)...);
+            std::construct_at(Data() + size_, std::move(Data()[size_ - 1]));
+            ++size_;
+            std::move_backward(pos_ptr, Data() + size_ - 2, Data() + size_ - 1);
+            *pos_ptr = std::move(temp);
+            return pos_ptr;
+        }
+        ++size_;
+        return pos_ptr;
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    constexpr iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= begin() && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    constexpr iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(first >= begin() && first <= last && last <= end());
+        T* mutable_first = Data() + (first - begin());
+        T* new_end = std::move(Data() + (last - begin()), end(), mutable_first);
+        std::destroy(new_end, end());
+        size_ = new_end - Data();
+        return mutable_first;
+    }
+
+    // Удаляет все элементы, удовлетворяющие pred, за один проход и возвращает их количество
+    template <typename Pred>
+    friend constexpr size_t EraseIf(StaticVector& v, Pred pred) {
+        T* new_end = std::remove_if(v.begin(), v.end(), pred);
+        const size_t count = v.end() - new_end;
+        std::destroy(new_end, v.end());
+        v.size_ -= count;
+        return count;
+    }
+
+    friend constexpr bool operator==(const StaticVector& lhs, const StaticVector& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    constexpr T* Data() noexcept {
+        return elements_;
+    }
+
+    constexpr const T* Data() const noexcept {
+        return elements_;
+    }
+
+    // Перемещает элементы other, после чего other пуст
+    constexpr void TakeElements(StaticVector& other) {
+        detail::UninitializedMoveN(other.Data(), other.size_, Data());
+        size_ = other.size_;
+        other.Clear();
+    }
+
+    // Элементы объединения не создаются вместе с вектором, а живут с construct_at
+    // до destroy_at, как в буфере RawMemory. В отличие от массива байтов, это допускается constexpr.
+    union {
+        T elements_[N];
+    };
+    size_t size_ = 0;
+};
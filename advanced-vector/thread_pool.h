@@ -0,0 +1,219 @@
+#pragma once
+#include "allocators.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Пул потоков для параллельных алгоритмов. Run(num_tasks, ...) выполняет task(i) для всех
+// i из [0, num_tasks): каждый участник получает свой отрезок индексов и берёт их с начала,
+// а закончивший свой отрезок забирает половину остатка у соседа (work stealing), поэтому
+// задачи разной длительности не оставляют потоки без работы. Вызывающий поток тоже участвует.
+// Run из задачи пула выполняется последовательно в текущем потоке.
+class ThreadPool {
+public:
+    // num_threads — число участников вместе с вызывающим потоком
+    explicit ThreadPool(size_t num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1))
+        : num_threads_(std::max<size_t>(num_threads, 1))
+        , ranges_(std::make_unique<Range[]>(num_threads_))
+        , workers_(std::make_unique<std::thread[]>(num_threads_ - 1)) {
+        try {
+            for (size_t worker = 1; worker < num_threads_; ++worker) {
+                workers_[worker - 1] = std::thread([this, worker] {
+                    WorkerLoop(worker);
+                });
+            }
+        } catch (...) {
+            Stop();
+            throw;
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        Stop();
+    }
+
+    // Общий пул на hardware_concurrency() участников
+    static ThreadPool& Default() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t NumThreads() const noexcept {
+        return num_threads_;
+    }
+
+    // Выполняет task(i) для каждого i из [0, num_tasks) не более чем в max_threads потоках
+    // (0 — во всех) и ждёт завершения. Если задачи бросали исключения, оставшиеся задачи
+    // пропускаются, а первое исключение пробрасывается после завершения всех участников.
+    // Вызовы из разных потоков выполняются по очереди.
+    template <typename Task>
+    void Run(size_t num_tasks, size_t max_threads, Task&& task) {
+        const size_t threads = std::min({max_threads == 0 ? num_threads_ : max_threads, num_threads_, num_tasks});
+        if (threads <= 1 || inside_task_) {
+            for (size_t i = 0; i < num_tasks; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard run_lock(run_mutex_);
+        for (size_t participant = 0; participant < threads; ++participant) {
+            std::lock_guard range_lock(ranges_[participant].mutex);
+            ranges_[participant].next = num_tasks / threads * participant + std::min(participant, num_tasks % threads);
+            ranges_[participant].end = num_tasks / threads * (participant + 1) + std::min(participant + 1, num_tasks % threads);
+        }
+        {
+            std::lock_guard lock(mutex_);
+            invoke_ = [](void* context, size_t index) {
+                (*static_cast<std::remove_reference_t<Task>*>(context))(index);
+            };
+            context_ = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+            job_threads_ = threads;
+            active_ = threads;
+            error_ = nullptr;
+            failed_.store(false, std::memory_order_relaxed);
+            ++generation_;
+        }
+        work_cv_.notify_all();
+        Participate(0);
+
+        std::unique_lock lock(mutex_);
+        done_cv_.wait(lock, [this] {
+            return active_ == 0;
+        });
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    // Отрезок ещё не взятых задач участника
+    struct alignas(CACHE_LINE_SIZE) Range {
+        std::mutex mutex;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    void WorkerLoop(size_t participant) {
+        uint64_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                work_cv_.wait(lock, [this, seen_generation] {
+                    return stopping_ || generation_ != seen_generation;
+                });
+                if (stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+                if (participant >= job_threads_) {
+                    continue;
+                }
+            }
+            Participate(participant);
+        }
+    }
+
+    void Participate(size_t participant) noexcept {
+        inside_task_ = true;
+        size_t index = 0;
+        while (TakeTask(participant, index)) {
+            if (failed_.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            try {
+                invoke_(context_, index);
+            } catch (...) {
+                std::lock_guard lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+        inside_task_ = false;
+
+        std::lock_guard lock(mutex_);
+        if (--active_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+
+    // Берёт задачу из своего отрезка, а если он пуст — крадёт половину чужого.
+    // Задачи не добавляются во время Run, поэтому если красть нечего, работа закончена.
+    bool TakeTask(size_t participant, size_t& index) {
+        Range& own = ranges_[participant];
+        {
+            std::lock_guard lock(own.mutex);
+            if (own.next < own.end) {
+                index = own.next++;
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < job_threads_; ++offset) {
+            Range& victim = ranges_[(participant + offset) % job_threads_];
+            size_t first = 0;
+            size_t last = 0;
+            {
+                std::lock_guard lock(victim.mutex);
+                const size_t left = victim.end - victim.next;
+                if (left == 0) {
+                    continue;
+                }
+                last = victim.end;
+                first = last - (left + 1) / 2;
+                victim.end = first;
+            }
+            std::lock_guard lock(own.mutex);
+            index = first;
+            own.next = first + 1;
+            own.end = last;
+            return true;
+        }
+        return false;
+    }
+
+    void Stop() noexcept {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (size_t worker = 0; worker + 1 < num_threads_; ++worker) {
+            if (workers_[worker].joinable()) {
+                workers_[worker].join();
+            }
+        }
+    }
+
+    static inline thread_local bool inside_task_ = false;
+
+    const size_t num_threads_;
+    std::unique_ptr<Range[]> ranges_;
+    std::unique_ptr<std::thread[]> workers_;
+
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+    size_t job_threads_ = 0;
+    size_t active_ = 0;
+    void (*invoke_)(void* context, size_t index) = nullptr;
+    void* context_ = nullptr;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+};
@@ -1,190 +1,921 @@
 #pragma once
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
+#include <cstddef>
+#include <cstring>
 #include <memory>
+#include <memory_resource>
 #include <new>
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <algorithm> 
+#include <bit>
+#include <concepts>
+#include <iterator>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <source_location>
+#include <string_view>
 
+// Объект такого типа можно перенести в другую память побайтовым копированием,
+// не вызывая деструктор старого объекта. Шаблон можно специализировать для своих типов.
 template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+template <typename T, typename D>
+struct IsTriviallyRelocatable<std::unique_ptr<T, D>> : IsTriviallyRelocatable<D> {
+};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Как переносить при перевыделении элементы, конструктор перемещения которых может бросить
+// исключение, а копирование возможно. Шаблон CopyFallbackPolicy можно специализировать для своих типов.
+enum class CopyFallback {
+    COPY,    // копировать: строгая гарантия безопасности исключений
+    REPORT,  // копировать, при первом переносе сообщив имя типа обработчику CopyFallbackHandler
+    FORBID,  // перенос копированием — ошибка компиляции
+    MOVE,    // всё равно перемещать: если перемещение бросит исключение, часть элементов
+             // останется в перемещённом состоянии (базовая гарантия)
+};
+
+template <typename T>
+struct CopyFallbackPolicy : std::integral_constant<CopyFallback, CopyFallback::COPY> {
+};
+
+template <typename T>
+inline constexpr CopyFallback CopyFallbackPolicyV = CopyFallbackPolicy<T>::value;
+
+// Получает имя типа и число элементов первого переноса копированием с политикой REPORT
+using CopyFallbackHandler = void (*)(std::string_view type_name, size_t count);
+
+// Параметры параллельного выполнения операций над всеми элементами вектора.
+// num_threads == 0 означает std::thread::hardware_concurrency(). Работа не делится
+// на отрезки меньше min_chunk_size элементов, поэтому маленькие векторы обрабатываются в одном потоке.
+struct ParallelPolicy {
+    size_t num_threads = 0;
+    size_t min_chunk_size = size_t{1} << 14;
+};
+
+inline constexpr ParallelPolicy PARALLEL{};
+
+namespace detail {
+
+// Алгоритмы std::uninitialized_* станут constexpr только в C++26, поэтому при вычислении
+// на этапе компиляции элементы создаются по одному. Исключение там не может быть выброшено
+// (оно делает выражение неконстантным), так что откат не нужен.
+template <typename T>
+constexpr void UninitializedValueConstructN(T* to, size_t n) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            std::construct_at(to + i);
+        }
+    } else {
+        std::uninitialized_value_construct_n(to, n);
+    }
+}
+
+// На этапе компиляции неинициализированные значения недопустимы, и элементы инициализируются значением
+template <typename T>
+constexpr void UninitializedDefaultConstructN(T* to, size_t n) {
+    if (std::is_constant_evaluated()) {
+        UninitializedValueConstructN(to, n);
+    } else {
+        std::uninitialized_default_construct_n(to, n);
+    }
+}
+
+template <typename It, typename T>
+constexpr void UninitializedCopyN(It from, size_t n, T* to) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < n; ++i, ++from) {
+            std::construct_at(to + i, *from);
+        }
+    } else {
+        std::uninitialized_copy_n(from, n, to);
+    }
+}
+
+template <typename T>
+constexpr void UninitializedMoveN(T* from, size_t n, T* to) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            std::construct_at(to + i, std::move(from[i]));
+        }
+    } else {
+        std::uninitialized_move_n(from, n, to);
+    }
+}
+
+// Имя T из сигнатуры функции: "... [with T = Session; ...]" в GCC, "... [T = Session]" в Clang
+template <typename T>
+constexpr std::string_view TypeName() noexcept {
+    const std::string_view signature = std::source_location::current().function_name();
+    const size_t start = signature.find("T = ");
+    if (start == std::string_view::npos) {
+        return signature;
+    }
+    const size_t end = signature.find_first_of(";]", start);
+    return signature.substr(start + 4, end == std::string_view::npos ? end : end - start - 4);
+}
+
+inline void PrintCopyFallback(std::string_view type_name, size_t count) noexcept {
+    std::fprintf(stderr, "Vector: relocating %zu elements of %.*s by copy: move constructor is not noexcept\n",
+                 count, static_cast<int>(type_name.size()), type_name.data());
+}
+
+inline std::atomic<CopyFallbackHandler> copy_fallback_handler{&PrintCopyFallback};
+
+// Элементы переносятся копированием, сохраняющим строгую гарантию
+template <typename T>
+inline constexpr bool RELOCATES_BY_COPY = !std::is_nothrow_move_constructible_v<T> && std::is_copy_constructible_v<T>
+    && CopyFallbackPolicyV<T> != CopyFallback::MOVE;
+
+// Один раз для каждого типа: статическая переменная инициализируется при первом вызове
+template <typename T>
+void ReportCopyFallback(size_t count) {
+    [[maybe_unused]] static const bool reported = (copy_fallback_handler.load()(TypeName<T>(), count), true);
+}
+
+// Перемещает элементы, если перемещение не бросает исключений (или копирование невозможно),
+// иначе копирует их, сохраняя строгую гарантию безопасности исключений. Копирование можно
+// запретить, отслеживать или заменить перемещением политикой CopyFallbackPolicy.
+template <typename T>
+constexpr void UninitializedMoveOrCopyN(T* from, size_t n, T* to) {
+    if constexpr (!RELOCATES_BY_COPY<T>) {
+        UninitializedMoveN(from, n, to);
+    } else {
+        static_assert(CopyFallbackPolicyV<T> != CopyFallback::FORBID,
+                      "Relocation would copy elements: make the move constructor noexcept "
+                      "or choose another CopyFallbackPolicy");
+        if constexpr (CopyFallbackPolicyV<T> == CopyFallback::REPORT) {
+            if (!std::is_constant_evaluated() && n != 0) {
+                ReportCopyFallback<T>(n);
+            }
+        }
+        UninitializedCopyN(from, n, to);
+    }
+}
+
+// Переносит n элементов в неинициализированную память to. Исходные элементы после
+// переноса считаются уничтоженными. Если было выброшено исключение, они не изменяются.
+template <typename T>
+constexpr void UninitializedRelocateN(T* from, size_t n, T* to) {
+    if (IsTriviallyRelocatableV<T> && !std::is_constant_evaluated()) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    } else {
+        UninitializedMoveOrCopyN(from, n, to);
+        std::destroy_n(from, n);
+    }
+}
+
+// Побайтово сдвигает n тривиально перемещаемых элементов внутри одного буфера; отрезки
+// могут перекрываться. На этапе компиляции memmove недоступен, и элементы переносятся
+// по одному в порядке, при котором каждый следующий попадает на уже освобождённое место.
+template <typename T>
+constexpr void RelocateOverlapping(T* from, size_t n, T* to) noexcept {
+    static_assert(IsTriviallyRelocatableV<T>);
+    if (std::is_constant_evaluated()) {
+        const auto relocate = [from, to](size_t i) {
+            std::construct_at(to + i, std::move(from[i]));
+            std::destroy_at(from + i);
+        };
+        if (to < from) {
+            for (size_t i = 0; i < n; ++i) {
+                relocate(i);
+            }
+        } else {
+            for (size_t i = n; i-- > 0;) {
+                relocate(i);
+            }
+        }
+    } else if (n != 0) {
+        std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+    }
+}
+
+// Делит [0, n) на отрезки по числу потоков и выполняет op(begin, end) для каждого отрезка
+// в отдельном потоке, первый — в вызывающем. Разбиение зависит только от n и policy, поэтому
+// вызовы с одинаковыми аргументами отдают каждому потоку одни и те же элементы.
+// Если op бросил исключение, для всех завершившихся успешно отрезков вызывается
+// undo(begin, end), после чего первое исключение пробрасывается дальше. Отрезок,
+// в котором произошло исключение, op должен откатить сам.
+template <typename Op, typename Undo>
+void ParallelFor(size_t n, const ParallelPolicy& policy, Op op, Undo undo) {
+    const size_t max_threads = policy.num_threads != 0
+        ? policy.num_threads
+        : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t num_chunks = std::clamp<size_t>(n / std::max<size_t>(policy.min_chunk_size, 1), 1, max_threads);
+    // Без памяти под служебные массивы работа выполняется в одном потоке
+    std::unique_ptr<std::exception_ptr[]> errors(num_chunks > 1 ? new (std::nothrow) std::exception_ptr[num_chunks]
+                                                                : nullptr);
+    std::unique_ptr<std::thread[]> threads(errors ? new (std::nothrow) std::thread[num_chunks - 1] : nullptr);
+    if (!threads) {
+        op(size_t{0}, n);
+        return;
+    }
+
+    const auto bound = [n, num_chunks](size_t chunk) {
+        return n / num_chunks * chunk + std::min(chunk, n % num_chunks);
+    };
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            op(bound(chunk), bound(chunk + 1));
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+        try {
+            threads[chunk - 1] = std::thread(run, chunk);
+        } catch (...) {
+            // Поток не запустился: отрезок выполняется после первого в вызывающем потоке
+        }
+    }
+    run(0);
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+        if (threads[chunk - 1].joinable()) {
+            threads[chunk - 1].join();
+        } else {
+            run(chunk);
+        }
+    }
+
+    std::exception_ptr error;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        if (errors[chunk] && !error) {
+            error = errors[chunk];
+        }
+    }
+    if (error) {
+        for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+            if (!errors[chunk]) {
+                undo(bound(chunk), bound(chunk + 1));
+            }
+        }
+        std::rethrow_exception(error);
+    }
+}
+
+// Итератор, бесконечно повторяющий одно значение. Используется для вставки count копий value.
+template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    constexpr RepeatIterator() = default;
+
+    constexpr explicit RepeatIterator(const T& value) noexcept
+        : value_(&value) {
+    }
+
+    constexpr reference operator*() const noexcept {
+        return *value_;
+    }
+
+    constexpr pointer operator->() const noexcept {
+        return value_;
+    }
+
+    constexpr RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    constexpr RepeatIterator operator++(int) noexcept {
+        RepeatIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    friend constexpr bool operator==(const RepeatIterator& lhs, const RepeatIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+private:
+    const T* value_ = nullptr;
+    size_t index_ = 0;
+};
+
+}  // namespace detail
+
+// Устанавливает обработчик отчётов CopyFallback::REPORT (по умолчанию — вывод в stderr)
+// и возвращает предыдущий. Каждый тип сообщается не больше одного раза.
+inline CopyFallbackHandler SetCopyFallbackHandler(CopyFallbackHandler handler) noexcept {
+    return detail::copy_fallback_handler.exchange(handler);
+}
+
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public:
-    RawMemory() = default;
+    using allocator_type = Alloc;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity)), capacity_(capacity) {
+    constexpr RawMemory() = default;
+
+    constexpr explicit RawMemory(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    constexpr explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : alloc_(alloc), buffer_(Allocate(capacity)), capacity_(capacity) {
     }
 
-    RawMemory(RawMemory&& other) noexcept {
-        Swap(other);
+    constexpr RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
     }
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
-        Swap(rhs);
+    // Аллокатор перемещается вместе с буфером, только если этого требует
+    // propagate_on_container_move_assignment. Иначе аллокаторы должны быть равны.
+    constexpr RawMemory& operator=(RawMemory&& rhs) noexcept {
+        std::swap(buffer_, rhs.buffer_);
+        std::swap(capacity_, rhs.capacity_);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            std::swap(alloc_, rhs.alloc_);
+        }
         return *this;
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory&) = delete;
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    constexpr ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    constexpr T* operator+(size_t offset) noexcept {
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    constexpr const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap.
+    // Иначе аллокаторы должны быть равны.
+    constexpr void Swap(RawMemory& other) noexcept {
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
     }
 
-    const T* GetAddress() const noexcept {
+    // Аллокатор умеет менять размер буфера на месте (например, через realloc или mremap)
+    static constexpr bool CAN_REALLOCATE = requires(Alloc& alloc, T* buf, size_t n) {
+        { alloc.reallocate(buf, n, n) } -> std::same_as<T*>;
+    };
+
+    // Меняет ёмкость, побайтово сохраняя содержимое буфера. Подходит только
+    // для тривиально перемещаемых T. При исключении буфер не изменяется.
+    constexpr void Reallocate(size_t new_capacity) requires CAN_REALLOCATE {
+        if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+        } else if (new_capacity == 0) {
+            Deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+        } else {
+            buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+        }
+        capacity_ = new_capacity;
+    }
+
+    // Освобождает буфер и заменяет аллокатор (для propagate_on_container_copy_assignment)
+    constexpr void Reset(const Alloc& alloc) noexcept {
+        Deallocate(buffer_, capacity_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        alloc_ = alloc;
+    }
+
+    // Освобождает текущий буфер и принимает во владение buf, выделенный аллокатором, равным alloc_
+    constexpr void Adopt(T* buf, size_t capacity) noexcept {
+        Deallocate(buffer_, capacity_);
+        buffer_ = buf;
+        capacity_ = capacity;
+    }
+
+    // Отдаёт буфер вызывающему, который должен освободить его аллокатором, равным alloc_
+    constexpr T* Release() noexcept {
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    constexpr const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    constexpr T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    constexpr size_t Capacity() const {
         return capacity_;
     }
 
+    constexpr const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
 private:
-    static T* Allocate(size_t n) {
-        return n ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    constexpr T* Allocate(size_t n) {
+        return n ? AllocTraits::allocate(alloc_, n) : nullptr;
     }
 
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    constexpr void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+        }
     }
 
+    [[no_unique_address]] Alloc alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+// Политики роста ёмкости. NextCapacity<T>(capacity) возвращает новую ёмкость,
+// строго большую текущей, для вектора с элементами типа T.
+
+// Удвоение ёмкости
+template <size_t MinCapacity = 1>
+struct DoublingGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity) noexcept {
+        return std::max(MinCapacity, capacity * 2);
+    }
+};
+
+// Рост в 1.5 раза: меньше неиспользуемой памяти ценой более частых реаллокаций
+template <size_t MinCapacity = 4>
+struct OneAndHalfGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity) noexcept {
+        return std::max(MinCapacity, capacity + std::max<size_t>(1, capacity / 2));
+    }
+};
+
+// Удвоение с округлением размера буфера в байтах до степени двойки, чтобы
+// запрос попадал точно в размерный класс аллокатора и не оставлял хвостов
+template <size_t MinBytes = 64>
+struct PowerOfTwoBytesGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity) noexcept {
+        const size_t bytes = std::bit_ceil(std::max(MinBytes, std::max<size_t>(capacity * 2, 1) * sizeof(T)));
+        return std::max(capacity + 1, bytes / sizeof(T));
+    }
+};
+
+// Удвоение до порога, после него — рост фиксированными шагами
+template <size_t ThresholdBytes = (size_t{64} << 20), size_t StepBytes = (size_t{64} << 20), size_t MinCapacity = 1>
+struct LinearAfterThresholdGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity) noexcept {
+        if (capacity * sizeof(T) < ThresholdBytes) {
+            return std::max(MinCapacity, capacity * 2);
+        }
+        return capacity + std::max<size_t>(1, StepBytes / sizeof(T));
+    }
+};
+
+// Способ переноса элементов при перевыделении буфера
+enum class RelocationKind {
+    IN_PLACE,  // буфер изменён аллокатором на месте (realloc, mremap)
+    BITWISE,   // memcpy тривиально перемещаемых элементов
+    MOVE,      // поэлементное перемещение
+    COPY,      // поэлементное копирование: конструктор перемещения может бросить исключение
+};
+
+// Политики статистики. Vector сообщает политике о выделениях памяти и переносах
+// элементов; при ENABLED == false вызовы и замеры времени не компилируются.
+struct NoStats {
+    static constexpr bool ENABLED = false;
+
+    void OnAllocation(size_t /*bytes*/) noexcept {
+    }
+
+    void OnRelocation(RelocationKind /*kind*/, size_t /*count*/, std::chrono::nanoseconds /*elapsed*/) noexcept {
+    }
+};
+
+struct CountingStats {
+    static constexpr bool ENABLED = true;
+
+    void OnAllocation(size_t bytes) noexcept {
+        ++allocations;
+        allocated_bytes += bytes;
+    }
+
+    void OnRelocation(RelocationKind kind, size_t count, std::chrono::nanoseconds elapsed) noexcept {
+        ++reallocations;
+        switch (kind) {
+            case RelocationKind::IN_PLACE:
+                relocated_in_place += count;
+                break;
+            case RelocationKind::BITWISE:
+                relocated_bitwise += count;
+                break;
+            case RelocationKind::MOVE:
+                relocated_by_move += count;
+                break;
+            case RelocationKind::COPY:
+                relocated_by_copy += count;
+                break;
+        }
+        relocation_time += elapsed;
+    }
+
+    size_t allocations = 0;
+    size_t allocated_bytes = 0;
+    size_t reallocations = 0;
+    size_t relocated_in_place = 0;
+    size_t relocated_bitwise = 0;
+    size_t relocated_by_move = 0;
+    size_t relocated_by_copy = 0;
+    std::chrono::nanoseconds relocation_time{0};
+};
+
+// Тег для создания элементов инициализацией по умолчанию: тривиальные типы не зануляются
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag DEFAULT_INIT{};
+
+// Буфер, отданный вектором через Release: первые size из capacity элементов созданы
 template <typename T>
+struct ReleasedBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Операции вектора, кроме параллельных, доступны при вычислении на этапе компиляции. Память,
+// выделенная при таком вычислении, должна быть в нём же освобождена, поэтому таблицу,
+// построенную в constexpr-функции, возвращают, например, в виде std::array.
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth<>,
+          typename Stats = NoStats>
 class Vector { 
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public: 
-    Vector() noexcept = default; 
+    using allocator_type = Alloc;
+
+    constexpr Vector() noexcept(noexcept(Alloc())) = default; 
+
+    constexpr explicit Vector(const Alloc& alloc) noexcept
+        : data_(alloc) {
+    }
 
-    explicit Vector(size_t size) 
-        : data_(size), size_(size) { 
-        std::uninitialized_value_construct_n(data_.GetAddress(), size_); 
+    constexpr explicit Vector(size_t size, const Alloc& alloc = Alloc()) 
+        : data_(NewBuffer(size, alloc)), size_(size) { 
+        detail::UninitializedValueConstructN(data_.GetAddress(), size_); 
     } 
 
-    Vector(const Vector& other) 
-        : data_(other.size_), size_(other.size_) { 
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress()); 
+    constexpr Vector(size_t size, DefaultInitTag, const Alloc& alloc = Alloc())
+        : data_(NewBuffer(size, alloc)), size_(size) {
+        detail::UninitializedDefaultConstructN(data_.GetAddress(), size_);
+    }
+
+    // Элементы создаются в нескольких потоках, и каждый поток первым касается своих страниц
+    // буфера. При последующей обработке с той же policy потоки получают те же отрезки,
+    // то есть память со своего узла NUMA. Исключение в любом потоке откатывает все отрезки.
+    Vector(size_t size, const ParallelPolicy& policy, const Alloc& alloc = Alloc())
+        : data_(NewBuffer(size, alloc)), size_(size) {
+        T* const data = data_.GetAddress();
+        detail::ParallelFor(
+            size, policy,
+            [data](size_t first, size_t last) {
+                std::uninitialized_value_construct_n(data + first, last - first);
+            },
+            [data](size_t first, size_t last) noexcept {
+                std::destroy_n(data + first, last - first);
+            });
+    }
+
+    constexpr Vector(const Vector& other) 
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) { 
     } 
 
-    Vector(Vector&& other) noexcept 
+    constexpr Vector(const Vector& other, const Alloc& alloc)
+        : data_(NewBuffer(other.size_, alloc)), size_(other.size_) {
+        detail::UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+    Vector(const Vector& other, const ParallelPolicy& policy)
+        : Vector(other, policy, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
+
+    Vector(const Vector& other, const ParallelPolicy& policy, const Alloc& alloc)
+        : data_(NewBuffer(other.size_, alloc)), size_(other.size_) {
+        const T* const from = other.data_.GetAddress();
+        T* const to = data_.GetAddress();
+        detail::ParallelFor(
+            size_, policy,
+            [from, to](size_t first, size_t last) {
+                std::uninitialized_copy_n(from + first, last - first, to + first);
+            },
+            [to](size_t first, size_t last) noexcept {
+                std::destroy_n(to + first, last - first);
+            });
+    }
+
+    template <std::input_iterator It>
+    constexpr Vector(It first, It last, const Alloc& alloc = Alloc())
+        : data_(alloc) {
+        if constexpr (std::forward_iterator<It>) {
+            const size_t size = static_cast<size_t>(std::distance(first, last));
+            RawMemory<T, Alloc> data = NewBuffer(size, alloc);
+            detail::UninitializedCopyN(first, size, data.GetAddress());
+            data_.Swap(data);
+            size_ = size;
+        } else {
+            // Исключение из конструктора не вызовет ~Vector, поэтому элементы копятся во временном векторе
+            Vector tmp(alloc);
+            for (; first != last; ++first) {
+                tmp.EmplaceBack(*first);
+            }
+            Swap(tmp);
+        }
+    }
+
+    constexpr Vector(Vector&& other) noexcept 
         : data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) { 
     } 
 
-    Vector& operator=(const Vector& rhs) { 
+    // При неравных аллокаторах буфер other забрать нельзя, поэтому элементы перемещаются по одному
+    constexpr Vector(Vector&& other, const Alloc& alloc)
+        : data_(alloc) {
+        if (alloc == other.data_.GetAllocator()) {
+            data_.Swap(other.data_);
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            RawMemory<T, Alloc> new_data = NewBuffer(other.size_, alloc);
+            detail::UninitializedMoveN(other.data_.GetAddress(), other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+        }
+    }
+
+    constexpr Vector& operator=(const Vector& rhs) { 
         if (this != &rhs) { 
-            if (rhs.size_ > data_.Capacity()) { 
-                Vector tmp(rhs); 
-                Swap(tmp); 
-            } else { 
-
-                // Вместо цикла использован существующий алгоритм std::copy_n
-                
-                std::copy_n(rhs.data_.GetAddress(), std::min(size_, rhs.size_), data_.GetAddress()); 
-                if (size_ < rhs.size_) { 
-                    std::uninitialized_copy_n(rhs.data_ + size_, rhs.size_ - size_, data_ + size_); 
-                } else if (size_ > rhs.size_) { 
-                    std::destroy_n(data_ + rhs.size_, size_ - rhs.size_); 
-                } 
-                size_ = rhs.size_; 
-            } 
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    // Память, выделенную старым аллокатором, может освободить только он сам
+                    std::destroy_n(data_.GetAddress(), size_);
+                    size_ = 0;
+                    data_.Reset(rhs.data_.GetAllocator());
+                }
+            }
+            AssignN(rhs.data_.GetAddress(), rhs.size_); 
         } 
         return *this; 
     } 
 
-    Vector& operator=(Vector&& rhs) noexcept { 
-        Swap(rhs); 
+    constexpr Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) { 
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                      || AllocTraits::is_always_equal::value) {
+            data_ = std::move(rhs.data_);
+            std::swap(size_, rhs.size_);
+        } else if (data_.GetAllocator() == rhs.data_.GetAllocator()) {
+            data_ = std::move(rhs.data_);
+            std::swap(size_, rhs.size_);
+        } else {
+            Vector tmp(std::move(rhs), data_.GetAllocator());
+            Swap(tmp);
+        }
         return *this; 
     } 
 
-    ~Vector() { 
+    constexpr ~Vector() { 
         std::destroy_n(data_.GetAddress(), size_); 
     } 
 
-    void Reserve(size_t new_capacity) { 
-        if (new_capacity <= data_.Capacity()) return; 
+    // Заменяет содержимое копией диапазона, не принадлежащего вектору. Существующие элементы
+    // переиспользуются присваиванием. Гарантия безопасности исключений — базовая.
+    template <std::input_iterator It>
+    constexpr void Assign(It first, It last) {
+        if constexpr (std::forward_iterator<It>) {
+            AssignN(first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            T* it = data_.GetAddress();
+            T* old_end = it + size_;
+            for (; it != old_end && first != last; ++it, ++first) {
+                *it = *first;
+            }
+            if (it != old_end) {
+                Erase(it, old_end);
+            }
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
 
-        RawMemory<T> new_data(new_capacity); 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) { 
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress()); 
-        } else { 
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress()); 
-        } 
-        std::destroy_n(data_.GetAddress(), size_); 
-        data_.Swap(new_data); 
+    constexpr void Assign(size_t count, const T& value) {
+        if (AliasesElements(value)) {
+            const T copy(value);
+            AssignN(detail::RepeatIterator<T>(copy), count);
+        } else {
+            AssignN(detail::RepeatIterator<T>(value), count);
+        }
+    }
+
+    constexpr Alloc GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    constexpr const Stats& GetStats() const noexcept {
+        return stats_;
+    }
+
+    constexpr void ResetStats() noexcept {
+        stats_ = Stats{};
+    }
+
+    constexpr void Reserve(size_t new_capacity) { 
+        if (new_capacity <= data_.Capacity()) return; 
+        ChangeCapacity(new_capacity); 
     } 
 
-    void Swap(Vector& other) noexcept { 
+    // Переносит элементы в новый буфер в нескольких потоках. Буфер, который растёт
+    // на месте через Alloc::reallocate, переносится как обычно.
+    void Reserve(size_t new_capacity, const ParallelPolicy& policy) {
+        if (new_capacity <= data_.Capacity()) return;
+        if constexpr (GROWS_IN_PLACE) {
+            ReallocateInPlace(new_capacity);
+        } else {
+            RawMemory<T, Alloc> new_data = NewBuffer(new_capacity, data_.GetAllocator());
+            TimedRelocation([&] {
+                ParallelRelocate(new_data.GetAddress(), policy);
+            });
+            data_.Swap(new_data);
+        }
+    }
+
+    constexpr void Clear() noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Уничтожает элементы в нескольких потоках. Удобно вызывать перед уничтожением
+    // большого вектора, деструктор которого работает в одном потоке.
+    void Clear(const ParallelPolicy& policy) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            T* const data = data_.GetAddress();
+            detail::ParallelFor(
+                size_, policy,
+                [data](size_t first, size_t last) noexcept {
+                    std::destroy_n(data + first, last - first);
+                },
+                [](size_t /*first*/, size_t /*last*/) noexcept {});
+        }
+        size_ = 0;
+    }
+
+    // Уменьшает ёмкость до размера, перенося элементы так же, как Reserve
+    constexpr void ShrinkToFit() {
+        if (data_.Capacity() > size_) {
+            ChangeCapacity(size_);
+        }
+    }
+
+    // Освобождает лишнюю память, если ёмкость превышает размер более чем в ratio раз.
+    // Возвращает true, если буфер был перевыделен.
+    constexpr bool ShrinkIfWasted(double ratio) {
+        assert(ratio >= 1.0);
+        if (static_cast<double>(data_.Capacity()) <= static_cast<double>(size_) * ratio) {
+            return false;
+        }
+        ChangeCapacity(size_);
+        return true;
+    }
+
+    // Объём памяти, занятой буфером, и часть его, не занятая элементами
+    constexpr size_t AllocatedBytes() const noexcept {
+        return data_.Capacity() * sizeof(T);
+    }
+
+    constexpr size_t WastedBytes() const noexcept {
+        return (data_.Capacity() - size_) * sizeof(T);
+    }
+
+    // Принимает во владение буфер buf на capacity элементов, первые size из которых уже созданы.
+    // Буфер должен быть выделен аллокатором, равным GetAllocator(); для чужих буферов
+    // с собственным освобождением см. AdoptBuffer. Текущие элементы уничтожаются.
+    constexpr void Adopt(T* buf, size_t size, size_t capacity) noexcept {
+        assert(size <= capacity);
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.Adopt(buf, capacity);
+        size_ = size;
+    }
+
+    // Отдаёт буфер вместе с элементами без копирования, вектор становится пустым.
+    // Вызывающий отвечает за уничтожение элементов и освобождение буфера аллокатором,
+    // равным GetAllocator(), либо может передать буфер в Adopt другого вектора.
+    [[nodiscard]] constexpr ReleasedBuffer<T> Release() noexcept {
+        const size_t capacity = data_.Capacity();
+        return {data_.Release(), std::exchange(size_, 0), capacity};
+    }
+
+    constexpr void Swap(Vector& other) noexcept { 
+        assert(AllocTraits::propagate_on_container_swap::value
+               || data_.GetAllocator() == other.data_.GetAllocator());
         data_.Swap(other.data_); 
         std::swap(size_, other.size_); 
     } 
 
-    size_t Size() const noexcept { 
+    constexpr size_t Size() const noexcept { 
         return size_; 
     } 
 
-    size_t Capacity() const noexcept { 
+    constexpr size_t Capacity() const noexcept { 
         return data_.Capacity(); 
     } 
 
-    const T& operator[](size_t index) const noexcept { 
+    constexpr const T& operator[](size_t index) const noexcept { 
         return const_cast<Vector&>(*this)[index]; 
     } 
 
-    T& operator[](size_t index) noexcept { 
+    constexpr T& operator[](size_t index) noexcept { 
         assert(index < size_); 
         return data_[index]; 
     } 
 
-    void Resize(size_t new_size) { 
+    constexpr void Resize(size_t new_size) { 
         if (new_size < size_) { 
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size); 
         } else { 
             if (new_size > data_.Capacity()) { 
                 Reserve(new_size); 
             } 
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_); 
+            detail::UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_); 
         } 
         size_ = new_size; 
     } 
 
-    void PushBack(const T& value) { 
+    // Как Resize, но новые элементы инициализируются по умолчанию. Для тривиальных
+    // типов их значения не определены, что удобно для буферов под read()/recv()
+    constexpr void ResizeDefaultInit(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+        } else {
+            Reserve(new_size);
+            detail::UninitializedDefaultConstructN(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Аналог basic_string::resize_and_overwrite из C++23: делает размер равным n
+    // (новые элементы инициализируются по умолчанию), вызывает op(data, n) и
+    // оставляет первые op(data, n) элементов. Результат op не должен превышать n.
+    template <typename Op>
+    constexpr void ResizeAndOverwrite(size_t n, Op op) {
+        ResizeDefaultInit(n);
+        const size_t new_size = static_cast<size_t>(std::move(op)(data_.GetAddress(), n));
+        assert(new_size <= n);
+        std::destroy_n(data_.GetAddress() + new_size, n - new_size);
+        size_ = new_size;
+    }
+
+    constexpr void PushBack(const T& value) { 
         EmplaceBack(value); 
     } 
 
-    void PushBack(T&& value) { 
+    constexpr void PushBack(T&& value) { 
         EmplaceBack(std::move(value)); 
     } 
 
-    void PopBack() noexcept { 
+    constexpr void PopBack() noexcept { 
         assert(size_ > 0); 
         std::destroy_at(data_.GetAddress() + --size_); 
     } 
@@ -195,26 +926,40 @@ public:
     // Поэтому EmplaceBack реализован отдельно для точного соответствия тестам.
     
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    constexpr T& EmplaceBack(Args&&... args) {
         if (size_ == Capacity()) {
-            size_t new_capacity = size_ == 0 ? 1 : size_ * 2;
-            RawMemory<T> new_data(new_capacity);
-
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-            } else {
-                std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+            const size_t new_capacity = Growth::template NextCapacity<T>(Capacity());
+            if constexpr (GROWS_IN_PLACE) {
+                // Аргументы могут ссылаться на элементы, а буфер при росте может переехать,
+                // поэтому новый элемент сначала создаётся во временном хранилище
+                alignas(T) std::byte storage[sizeof(T)];
+                T* temp = std::construct_at(reinterpret_cast<T*>(storage), std::forward<Args>(args)...);
+                try {
+                    ReallocateInPlace(new_capacity);
+                } catch (...) {
+                    std::destroy_at(temp);
+                    throw;
+                }
+                T* place = data_.GetAddress() + size_;
+                std::memcpy(static_cast<void*>(place), static_cast<const void*>(temp), sizeof(T));
+                ++size_;
+                return *place;
             }
+            RawMemory<T, Alloc> new_data = NewBuffer(new_capacity, data_.GetAllocator());
 
+            // Новый элемент создаётся до переноса старых, так как аргументы
+            // могут ссылаться на элементы самого вектора
             T* place = new_data.GetAddress() + size_;
+            std::construct_at(place, std::forward<Args>(args)...);
             try {
-                std::construct_at(place, std::forward<Args>(args)...);
+                TimedRelocation([&] {
+                    detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+                });
             } catch (...) {
-                std::destroy_n(new_data.GetAddress(), size_);
+                std::destroy_at(place);
                 throw;
             }
 
-            std::destroy_n(data_.GetAddress(), size_);
             data_.Swap(new_data);
             ++size_;
             return *place;
@@ -230,101 +975,508 @@ public:
     using iterator = T*; 
     using const_iterator = const T*; 
 
-    iterator begin() noexcept { 
+    constexpr iterator begin() noexcept { 
         return data_.GetAddress(); 
     } 
 
-    iterator end() noexcept { 
+    constexpr iterator end() noexcept { 
         return data_.GetAddress() + size_; 
     } 
 
-    const_iterator begin() const noexcept { 
+    constexpr const_iterator begin() const noexcept { 
         return data_.GetAddress(); 
     } 
 
-    const_iterator end() const noexcept { 
+    constexpr const_iterator end() const noexcept { 
         return data_.GetAddress() + size_; 
     } 
 
-    const_iterator cbegin() const noexcept { 
+    constexpr const_iterator cbegin() const noexcept { 
         return begin(); 
     } 
 
-    const_iterator cend() const noexcept { 
+    constexpr const_iterator cend() const noexcept { 
         return end(); 
     } 
 
     template <typename... Args> 
-    iterator Emplace(const_iterator pos, Args&&... args) { 
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) { 
         size_t index = pos - begin(); 
         return size_ == Capacity() 
             ? EmplaceWithRealloc(index, std::forward<Args>(args)...) 
             : EmplaceWithoutRealloc(index, std::forward<Args>(args)...); 
     } 
 
-    iterator Insert(const_iterator pos, const T& value) { 
+    constexpr iterator Insert(const_iterator pos, const T& value) { 
         return Emplace(pos, value); 
     } 
 
-    iterator Insert(const_iterator pos, T&& value) { 
+    constexpr iterator Insert(const_iterator pos, T&& value) { 
         return Emplace(pos, std::move(value)); 
     } 
 
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) { 
+    template <std::input_iterator It>
+    constexpr iterator Insert(const_iterator pos, It first, It last) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+        if constexpr (std::forward_iterator<It>) {
+            return InsertN(index, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            // Количество элементов заранее неизвестно: дописываем в конец и сдвигаем на место
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        }
+    }
+
+    constexpr iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+        if (AliasesElements(value)) {
+            // value лежит в самом векторе и может быть сдвинуто или перемещено
+            const T copy(value);
+            return InsertN(index, detail::RepeatIterator<T>(copy), count);
+        }
+        return InsertN(index, detail::RepeatIterator<T>(value), count);
+    }
+
+    // Дописывает элементы в конец. values не должен ссылаться на элементы самого вектора.
+    constexpr void Append(std::span<const T> values) {
+        InsertN(size_, values.begin(), values.size());
+    }
+
+    constexpr iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T> || IsTriviallyRelocatableV<T>) { 
         assert(pos >= begin() && pos < end()); 
-        T* mutable_pos = data_.GetAddress() + (pos - begin()); 
-        std::move(mutable_pos + 1, data_.GetAddress() + size_, mutable_pos); 
-        std::destroy_at(data_.GetAddress() + --size_); 
-        return mutable_pos; 
+        return Erase(pos, pos + 1); 
     } 
 
+    constexpr iterator Erase(const_iterator first, const_iterator last)
+            noexcept(std::is_nothrow_move_assignable_v<T> || IsTriviallyRelocatableV<T>) {
+        assert(first >= begin() && first <= last && last <= end());
+        T* mutable_first = data_.GetAddress() + (first - begin());
+        T* mutable_last = data_.GetAddress() + (last - begin());
+        const size_t count = last - first;
+        if (count == 0) {
+            return mutable_first;
+        }
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            std::destroy_n(mutable_first, count);
+            detail::RelocateOverlapping(mutable_last, end() - mutable_last, mutable_first);
+        } else {
+            std::move(mutable_last, end(), mutable_first);
+            std::destroy_n(end() - count, count);
+        }
+        size_ -= count;
+        return mutable_first;
+    }
+
+    // Удаляет все элементы, удовлетворяющие pred, за один проход и возвращает их количество
+    template <typename Pred>
+    friend constexpr size_t EraseIf(Vector& v, Pred pred) {
+        return v.EraseIfImpl(pred);
+    }
+
+    // Целые, перечисления и указатели равны тогда и только тогда, когда совпадают их байты,
+    // поэтому сравнение сводится к memcmp, векторизованному в libc
+    friend constexpr bool operator==(const Vector& lhs, const Vector& rhs) {
+        if (lhs.size_ != rhs.size_) {
+            return false;
+        }
+        if ((std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) && !std::is_constant_evaluated()) {
+            return lhs.size_ == 0
+                || std::memcmp(lhs.data_.GetAddress(), rhs.data_.GetAddress(), lhs.size_ * sizeof(T)) == 0;
+        } else {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+        }
+    }
+
 private: 
 
     // Добавлены 2 вспомогательные функции
     // вставки с релокацией памяти и без
 
     template <typename... Args> 
-    iterator EmplaceWithRealloc(size_t index, Args&&... args) { 
-        size_t new_capacity = size_ == 0 ? 1 : size_ * 2; 
-        RawMemory<T> new_data(new_capacity); 
+    constexpr iterator EmplaceWithRealloc(size_t index, Args&&... args) { 
+        const size_t new_capacity = Growth::template NextCapacity<T>(Capacity()); 
+        if constexpr (GROWS_IN_PLACE) {
+            alignas(T) std::byte storage[sizeof(T)];
+            T* temp = std::construct_at(reinterpret_cast<T*>(storage), std::forward<Args>(args)...);
+            try {
+                ReallocateInPlace(new_capacity);
+            } catch (...) {
+                std::destroy_at(temp);
+                throw;
+            }
+            T* pos = data_.GetAddress() + index;
+            std::memmove(static_cast<void*>(pos + 1), static_cast<const void*>(pos), (size_ - index) * sizeof(T));
+            std::memcpy(static_cast<void*>(pos), static_cast<const void*>(temp), sizeof(T));
+            ++size_;
+            return pos;
+        }
+        RawMemory<T, Alloc> new_data = NewBuffer(new_capacity, data_.GetAllocator()); 
         T* new_pos = new_data.GetAddress() + index; 
-
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) { 
-            std::uninitialized_move_n(data_.GetAddress(), index, new_data.GetAddress()); 
-            std::construct_at(new_pos, std::forward<Args>(args)...); 
-            std::uninitialized_move_n(data_.GetAddress() + index, size_ - index, new_pos + 1); 
-        } else { 
-            std::uninitialized_copy_n(data_.GetAddress(), index, new_data.GetAddress()); 
-            std::construct_at(new_pos, std::forward<Args>(args)...); 
-            std::uninitialized_copy_n(data_.GetAddress() + index, size_ - index, new_pos + 1); 
-        } 
-
-        std::destroy_n(data_.GetAddress(), size_); 
+        std::construct_at(new_pos, std::forward<Args>(args)...); 
+        RelocateAroundGap(new_data, index, 1);
         data_.Swap(new_data); 
         ++size_; 
         return new_pos; 
     } 
 
+    // Присваивает первым элементам новые значения и создаёт или уничтожает остаток.
+    // Если ёмкости не хватает, старые элементы при дешёвом перемещении переносятся
+    // в новый буфер, чтобы их ресурсы (например, память строк) переиспользовались.
+    template <std::forward_iterator It>
+    constexpr void AssignN(It first, size_t n) {
+        if constexpr (std::is_trivially_copyable_v<T> && std::contiguous_iterator<It>
+                      && std::is_same_v<std::iter_value_t<It>, T>) {
+            // На этапе компиляции memcpy недоступен, и работает общий путь
+            if (!std::is_constant_evaluated()) {
+                if (n > data_.Capacity()) {
+                    RawMemory<T, Alloc> new_data = NewBuffer(n, data_.GetAllocator());
+                    data_.Swap(new_data);
+                }
+                if (n != 0) {
+                    std::memcpy(static_cast<void*>(data_.GetAddress()), static_cast<const void*>(std::to_address(first)),
+                                n * sizeof(T));
+                }
+                size_ = n;
+                return;
+            }
+        }
+        if (n > data_.Capacity()) {
+            if constexpr (RELOCATION_KIND == RelocationKind::COPY) {
+                // Перенос старых элементов был бы копированием, поэтому создаём все заново
+                RawMemory<T, Alloc> new_data = NewBuffer(n, data_.GetAllocator());
+                detail::UninitializedCopyN(first, n, new_data.GetAddress());
+                std::destroy_n(data_.GetAddress(), size_);
+                data_.Swap(new_data);
+                size_ = n;
+                return;
+            } else {
+                ChangeCapacity(n);
+            }
+        }
+        T* out = data_.GetAddress();
+        for (T* common_end = out + std::min(size_, n); out != common_end; ++out, ++first) {
+            *out = *first;
+        }
+        if (size_ < n) {
+            detail::UninitializedCopyN(first, n - size_, data_.GetAddress() + size_);
+        } else {
+            std::destroy_n(data_.GetAddress() + n, size_ - n);
+        }
+        size_ = n;
+    }
+
+    constexpr void ChangeCapacity(size_t new_capacity) {
+        if constexpr (GROWS_IN_PLACE) {
+            ReallocateInPlace(new_capacity);
+        } else {
+            RawMemory<T, Alloc> new_data = NewBuffer(new_capacity, data_.GetAllocator());
+            TimedRelocation([&] {
+                detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+            });
+            data_.Swap(new_data);
+        }
+    }
+
+    // Параллельный UninitializedRelocateN всех элементов в new_data. Исходные элементы
+    // уничтожаются только после того, как все отрезки перенесены.
+    void ParallelRelocate(T* new_data, const ParallelPolicy& policy) {
+        T* const old_data = data_.GetAddress();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            detail::ParallelFor(
+                size_, policy,
+                [old_data, new_data](size_t first, size_t last) noexcept {
+                    detail::UninitializedRelocateN(old_data + first, last - first, new_data + first);
+                },
+                [](size_t /*first*/, size_t /*last*/) noexcept {});
+        } else {
+            detail::ParallelFor(
+                size_, policy,
+                [old_data, new_data](size_t first, size_t last) {
+                    detail::UninitializedMoveOrCopyN(old_data + first, last - first, new_data + first);
+                },
+                [new_data](size_t first, size_t last) noexcept {
+                    std::destroy_n(new_data + first, last - first);
+                });
+            detail::ParallelFor(
+                size_, policy,
+                [old_data](size_t first, size_t last) noexcept {
+                    std::destroy_n(old_data + first, last - first);
+                },
+                [](size_t /*first*/, size_t /*last*/) noexcept {});
+        }
+    }
+
+    constexpr RawMemory<T, Alloc> NewBuffer(size_t capacity, const Alloc& alloc) {
+        RawMemory<T, Alloc> buffer(capacity, alloc);
+        if constexpr (Stats::ENABLED) {
+            if (capacity != 0) {
+                stats_.OnAllocation(capacity * sizeof(T));
+            }
+        }
+        return buffer;
+    }
+
+    constexpr void ReallocateInPlace(size_t new_capacity) {
+        if constexpr (Stats::ENABLED) {
+            stats_.OnAllocation(new_capacity * sizeof(T));
+        }
+        TimedRelocation([&] {
+            data_.Reallocate(new_capacity);
+        });
+    }
+
+    // Переносит текущие size_ элементов, сообщая политике статистики способ переноса и время.
+    // Первое выделение буфера перевыделением не считается.
+    template <typename Relocate>
+    constexpr void TimedRelocation(Relocate&& relocate) {
+        if constexpr (Stats::ENABLED) {
+            const bool is_reallocation = data_.Capacity() != 0;
+            const auto start = std::chrono::steady_clock::now();
+            relocate();
+            if (is_reallocation) {
+                stats_.OnRelocation(RELOCATION_KIND, size_, std::chrono::steady_clock::now() - start);
+            }
+        } else {
+            relocate();
+        }
+    }
+
+    template <typename Pred>
+    constexpr size_t EraseIfImpl(Pred& pred) {
+        const size_t old_size = size_;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            // Оставляемые элементы сдвигаются целыми отрезками, удаляемые сразу уничтожаются
+            T* const first = begin();
+            T* const last = end();
+            T* write = first;
+            T* run = first;
+            auto flush_run = [&write, &run](T* run_end) {
+                const size_t run_size = run_end - run;
+                if (write != run) {
+                    detail::RelocateOverlapping(run, run_size, write);
+                }
+                write += run_size;
+            };
+            try {
+                for (T* read = first; read != last; ++read) {
+                    if (pred(*read)) {
+                        flush_run(read);
+                        std::destroy_at(read);
+                        run = read + 1;
+                    }
+                }
+            } catch (...) {
+                flush_run(last);
+                size_ = write - first;
+                throw;
+            }
+            flush_run(last);
+            size_ = write - first;
+        } else {
+            T* new_end = std::remove_if(begin(), end(), pred);
+            const size_t count = end() - new_end;
+            std::destroy_n(new_end, count);
+            size_ -= count;
+        }
+        return old_size - size_;
+    }
+
+    // Переносит элементы [0, index) в начало new_data, а [index, size_) — за промежуток
+    // из gap уже созданных в new_data элементов. При исключении промежуток уничтожается.
+    constexpr void RelocateAroundGap(RawMemory<T, Alloc>& new_data, size_t index, size_t gap) {
+        TimedRelocation([&] {
+            RelocateAroundGapImpl(new_data, index, gap);
+        });
+    }
+
+    constexpr void RelocateAroundGapImpl(RawMemory<T, Alloc>& new_data, size_t index, size_t gap) {
+        T* new_pos = new_data.GetAddress() + index;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            detail::UninitializedRelocateN(data_.GetAddress(), index, new_data.GetAddress());
+            detail::UninitializedRelocateN(data_.GetAddress() + index, size_ - index, new_pos + gap);
+        } else {
+            try {
+                detail::UninitializedMoveOrCopyN(data_.GetAddress(), index, new_data.GetAddress());
+            } catch (...) {
+                std::destroy_n(new_pos, gap);
+                throw;
+            }
+            try {
+                detail::UninitializedMoveOrCopyN(data_.GetAddress() + index, size_ - index, new_pos + gap);
+            } catch (...) {
+                std::destroy_n(new_data.GetAddress(), index + gap);
+                throw;
+            }
+            std::destroy_n(data_.GetAddress(), size_);
+        }
+    }
+
+    // Вставляет n элементов из [first, first + n). Диапазон не должен принадлежать вектору.
+    template <std::forward_iterator It>
+    constexpr iterator InsertN(size_t index, It first, size_t n) {
+        if (n == 0) {
+            return begin() + index;
+        }
+        if (size_ + n > Capacity()) {
+            const size_t new_capacity = std::max(Growth::template NextCapacity<T>(Capacity()), size_ + n);
+            if constexpr (GROWS_IN_PLACE) {
+                ReallocateInPlace(new_capacity);
+            } else {
+                // Новые элементы создаются сразу на своих местах, а старые переносятся один раз
+                RawMemory<T, Alloc> new_data = NewBuffer(new_capacity, data_.GetAllocator());
+                T* new_pos = new_data.GetAddress() + index;
+                detail::UninitializedCopyN(first, n, new_pos);
+                RelocateAroundGap(new_data, index, n);
+                data_.Swap(new_data);
+                size_ += n;
+                return new_pos;
+            }
+        }
+
+        T* pos = data_.GetAddress() + index;
+        T* old_end = data_.GetAddress() + size_;
+        const size_t tail = size_ - index;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            detail::RelocateOverlapping(pos, tail, pos + n);
+            try {
+                detail::UninitializedCopyN(first, n, pos);
+            } catch (...) {
+                detail::RelocateOverlapping(pos + n, tail, pos);
+                throw;
+            }
+            size_ += n;
+        } else if (tail > n) {
+            detail::UninitializedMoveN(old_end - n, n, old_end);
+            size_ += n;
+            std::move_backward(pos, old_end - n, old_end);
+            std::copy_n(first, n, pos);
+        } else {
+            It mid = std::next(first, tail);
+            detail::UninitializedCopyN(mid, n - tail, old_end);
+            try {
+                detail::UninitializedMoveN(pos, tail, pos + n);
+            } catch (...) {
+                std::destroy_n(old_end, n - tail);
+                throw;
+            }
+            size_ += n;
+            std::copy_n(first, tail, pos);
+        }
+        return pos;
+    }
+
     template <typename... Args> 
-    iterator EmplaceWithoutRealloc(size_t index, Args&&... args) { 
-        T temp(std::forward<Args>(args)...); 
+    constexpr iterator EmplaceWithoutRealloc(size_t index, Args&&... args) { 
         T* pos_ptr = data_.GetAddress() + index; 
 
-        if (index < size_) { 
-            std::construct_at(data_.GetAddress() + size_, std::move(data_[size_ - 1])); 
-            for (size_t i = size_ - 1; i > index; --i) { 
-                data_[i] = std::move(data_[i - 1]); 
-            } 
+        if (index == size_) {
+            // Вставка в конец: место не занято, временный объект не нужен
+            std::construct_at(pos_ptr, std::forward<Args>(args)...); 
+        } else if constexpr (IsTriviallyRelocatableV<T>) {
+            if (std::is_constant_evaluated()) {
+                // Побайтовое хранилище недоступно на этапе компиляции
+                T temp(std::forward<Args>(args)...);
+                ShiftTailBitwise(index);
+                std::construct_at(pos_ptr, std::move(temp));
+            } else if (AliasesElements(args...)) {
+                // Аргумент лежит в сдвигаемой части: элемент создаётся до сдвига и переносится побайтово
+                alignas(T) std::byte storage[sizeof(T)];
+                T* temp = std::construct_at(reinterpret_cast<T*>(storage), std::forward<Args>(args)...);
+                ShiftTailBitwise(index);
+                std::memcpy(static_cast<void*>(pos_ptr), static_cast<const void*>(temp), sizeof(T));
+            } else {
+                ShiftTailBitwise(index);
+                try {
+                    std::construct_at(pos_ptr, std::forward<Args>(args)...);
+                } catch (...) {
+                    detail::RelocateOverlapping(pos_ptr + 1, size_ - index, pos_ptr);
+                    throw;
+                }
+            }
+        } else if (CAN_CONSTRUCT_IN_PLACE<Args...> && !AliasesElements(args...)) {
+            ShiftTailByOne(index);
+            if constexpr (IS_SINGLE_VALUE<Args...>) {
+                ((data_[index] = std::forward<Args>(args)), ...);
+            } else {
+                std::destroy_at(pos_ptr);
+                std::construct_at(pos_ptr, std::forward<Args>(args)...);
+            }
+            return pos_ptr;
+        } else {
+            T temp(std::forward<Args>(args)...); 
+            ShiftTailByOne(index);
             data_[index] = std::move(temp); 
-        } else { 
-            std::construct_at(pos_ptr, std::move(temp)); 
-        } 
+            return pos_ptr;
+        }
 
         ++size_; 
         return pos_ptr; 
     } 
 
-    RawMemory<T> data_; 
+    // Вставка одного значения T присваивается на место сдвинутого элемента, а для
+    // конструкторов без исключений сдвинутый элемент просто пересоздаётся
+    template <typename... Args>
+    static constexpr bool IS_SINGLE_VALUE = sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...);
+
+    template <typename... Args>
+    static constexpr bool CAN_CONSTRUCT_IN_PLACE = IS_SINGLE_VALUE<Args...> || std::is_nothrow_constructible_v<T, Args...>;
+
+    // Аргумент — сам элемент вектора или его часть, и сдвиг элементов изменит его.
+    // На этапе компиляции адреса несвязанных объектов несравнимы, и ответ всегда true.
+    template <typename... Args>
+    constexpr bool AliasesElements(const Args&... args) const noexcept {
+        if (std::is_constant_evaluated()) {
+            return true;
+        }
+        [[maybe_unused]] const auto is_inside = [this](const void* address) {
+            return std::less_equal<const void*>{}(data_.GetAddress(), address)
+                && std::less<const void*>{}(address, data_.GetAddress() + size_);
+        };
+        return (is_inside(std::addressof(args)) || ...);
+    }
+
+    // Сдвигает элементы [index, size_) на одну позицию вправо. На месте index остаётся
+    // перемещённый элемент. Размер увеличивается, как только создан новый последний элемент,
+    // поэтому при исключении из присваивания вектор остаётся корректным.
+    constexpr void ShiftTailByOne(size_t index) {
+        std::construct_at(data_.GetAddress() + size_, std::move(data_[size_ - 1]));
+        ++size_;
+        for (size_t i = size_ - 2; i > index; --i) {
+            data_[i] = std::move(data_[i - 1]);
+        }
+    }
+
+    // Сдвигает элементы [index, size_) на одну позицию вправо одним memmove; место index
+    // после этого не занято
+    constexpr void ShiftTailBitwise(size_t index) noexcept {
+        T* pos_ptr = data_.GetAddress() + index;
+        detail::RelocateOverlapping(pos_ptr, size_ - index, pos_ptr + 1);
+    }
+
+    // Тривиально перемещаемые элементы растут вместе с буфером без поэлементного переноса
+    static constexpr bool GROWS_IN_PLACE = IsTriviallyRelocatableV<T> && RawMemory<T, Alloc>::CAN_REALLOCATE;
+
+    static constexpr RelocationKind RELOCATION_KIND = GROWS_IN_PLACE ? RelocationKind::IN_PLACE
+        : IsTriviallyRelocatableV<T>                                 ? RelocationKind::BITWISE
+        : detail::RELOCATES_BY_COPY<T>                              ? RelocationKind::COPY
+                                                                     : RelocationKind::MOVE;
+
+    // Объявлен до data_, так как используется при его инициализации
+    [[no_unique_address]] Stats stats_; 
+    RawMemory<T, Alloc> data_; 
     size_t size_ = 0; 
 };
 
+namespace pmr {
+
+// Вектор поверх std::pmr::memory_resource, например std::pmr::monotonic_buffer_resource
+template <typename T, typename Growth = DoublingGrowth<>, typename Stats = NoStats>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, Growth, Stats>;
+
+}  // namespace pmr
@@ -0,0 +1,405 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ADVANCED_VECTOR_X86 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ADVANCED_VECTOR_NEON 1
+#endif
+
+// Поиск, подсчёт и минимум/максимум по непрерывным последовательностям (Vector, SmallVector,
+// std::vector, массивы). Для 32-битных целых и float используются ядра AVX2/AVX-512,
+// выбираемые во время выполнения, или NEON на AArch64. Для остальных типов — стандартные алгоритмы.
+namespace detail::simd {
+
+enum class Isa {
+    SCALAR,
+    AVX2,
+    AVX512,
+};
+
+inline Isa DetectIsa() noexcept {
+#ifdef ADVANCED_VECTOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+#endif
+    return Isa::SCALAR;
+}
+
+inline Isa GetIsa() noexcept {
+    static const Isa isa = DetectIsa();
+    return isa;
+}
+
+// Типы, для которых есть векторные ядра
+template <typename T>
+inline constexpr bool HAS_KERNELS = std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> || std::is_same_v<T, float>;
+
+template <typename T>
+size_t FindScalar(const T* data, size_t n, T value) noexcept {
+    return static_cast<size_t>(std::find(data, data + n, value) - data);
+}
+
+template <typename T>
+size_t CountScalar(const T* data, size_t n, T value) noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += data[i] == value;
+    }
+    return count;
+}
+
+template <typename T>
+std::pair<T, T> MinMaxScalar(const T* data, size_t n) noexcept {
+    T min = data[0];
+    T max = data[0];
+    for (size_t i = 1; i < n; ++i) {
+        min = data[i] < min ? data[i] : min;
+        max = max < data[i] ? data[i] : max;
+    }
+    return {min, max};
+}
+
+#ifdef ADVANCED_VECTOR_X86
+
+__attribute__((target("avx2"))) inline int EqualMaskAvx2(const int32_t* data, __m256i needle) noexcept {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(chunk, needle)));
+}
+
+__attribute__((target("avx2"))) inline int EqualMaskAvx2(const float* data, __m256 needle) noexcept {
+    return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data), needle, _CMP_EQ_OQ));
+}
+
+__attribute__((target("avx2"))) inline __m256i BroadcastAvx2(int32_t value) noexcept {
+    return _mm256_set1_epi32(value);
+}
+
+__attribute__((target("avx2"))) inline __m256 BroadcastAvx2(float value) noexcept {
+    return _mm256_set1_ps(value);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t FindAvx2(const T* data, size_t n, T value) noexcept {
+    const auto needle = BroadcastAvx2(value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (const int mask = EqualMaskAvx2(data + i, needle)) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+    return i + FindScalar(data + i, n - i, value);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t CountAvx2(const T* data, size_t n, T value) noexcept {
+    const auto needle = BroadcastAvx2(value);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(EqualMaskAvx2(data + i, needle))));
+    }
+    return count + CountScalar(data + i, n - i, value);
+}
+
+__attribute__((target("avx512f"))) inline __mmask16 EqualMaskAvx512(const int32_t* data, int32_t value) noexcept {
+    return _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data), _mm512_set1_epi32(value));
+}
+
+__attribute__((target("avx512f"))) inline __mmask16 EqualMaskAvx512(const float* data, float value) noexcept {
+    return _mm512_cmp_ps_mask(_mm512_loadu_ps(data), _mm512_set1_ps(value), _CMP_EQ_OQ);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) size_t FindAvx512(const T* data, size_t n, T value) noexcept {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if (const __mmask16 mask = EqualMaskAvx512(data + i, value)) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return i + FindScalar(data + i, n - i, value);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) size_t CountAvx512(const T* data, size_t n, T value) noexcept {
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        count += static_cast<size_t>(__builtin_popcount(EqualMaskAvx512(data + i, value)));
+    }
+    return count + CountScalar(data + i, n - i, value);
+}
+
+// Минимум и максимум: по 8 (AVX2) или 16 (AVX-512) независимых дорожек, затем свёртка дорожек
+#define ADVANCED_VECTOR_MINMAX_AVX2(TYPE, VEC, LOAD, MIN, MAX, STORE)                        \
+    __attribute__((target("avx2"))) inline std::pair<TYPE, TYPE> MinMaxAvx2(const TYPE* data, \
+                                                                             size_t n) noexcept { \
+        if (n < 8) {                                                                            \
+            return MinMaxScalar(data, n);                                                       \
+        }                                                                                       \
+        VEC min = LOAD(data);                                                                   \
+        VEC max = min;                                                                          \
+        size_t i = 8;                                                                           \
+        for (; i + 8 <= n; i += 8) {                                                            \
+            const VEC chunk = LOAD(data + i);                                                   \
+            min = MIN(min, chunk);                                                              \
+            max = MAX(max, chunk);                                                              \
+        }                                                                                       \
+        alignas(32) TYPE lanes_min[8];                                                          \
+        alignas(32) TYPE lanes_max[8];                                                          \
+        STORE(lanes_min, min);                                                                  \
+        STORE(lanes_max, max);                                                                  \
+        std::pair<TYPE, TYPE> result{MinMaxScalar(lanes_min, 8).first, MinMaxScalar(lanes_max, 8).second}; \
+        if (i < n) {                                                                            \
+            const auto tail = MinMaxScalar(data + i, n - i);                                    \
+            result.first = std::min(result.first, tail.first);                                  \
+            result.second = std::max(result.second, tail.second);                               \
+        }                                                                                       \
+        return result;                                                                          \
+    }
+
+#define ADVANCED_VECTOR_LOAD_SI256(ptr) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr))
+#define ADVANCED_VECTOR_STORE_SI256(ptr, v) _mm256_store_si256(reinterpret_cast<__m256i*>(ptr), v)
+
+ADVANCED_VECTOR_MINMAX_AVX2(int32_t, __m256i, ADVANCED_VECTOR_LOAD_SI256, _mm256_min_epi32, _mm256_max_epi32,
+                            ADVANCED_VECTOR_STORE_SI256)
+ADVANCED_VECTOR_MINMAX_AVX2(uint32_t, __m256i, ADVANCED_VECTOR_LOAD_SI256, _mm256_min_epu32, _mm256_max_epu32,
+                            ADVANCED_VECTOR_STORE_SI256)
+ADVANCED_VECTOR_MINMAX_AVX2(float, __m256, _mm256_loadu_ps, _mm256_min_ps, _mm256_max_ps, _mm256_store_ps)
+
+#undef ADVANCED_VECTOR_MINMAX_AVX2
+#undef ADVANCED_VECTOR_LOAD_SI256
+#undef ADVANCED_VECTOR_STORE_SI256
+
+#endif  // ADVANCED_VECTOR_X86
+
+#ifdef ADVANCED_VECTOR_NEON
+
+inline uint32x4_t EqualMaskNeon(const int32_t* data, int32_t value) noexcept {
+    return vceqq_s32(vld1q_s32(data), vdupq_n_s32(value));
+}
+
+inline uint32x4_t EqualMaskNeon(const float* data, float value) noexcept {
+    return vceqq_f32(vld1q_f32(data), vdupq_n_f32(value));
+}
+
+template <typename T>
+size_t FindNeon(const T* data, size_t n, T value) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        if (vmaxvq_u32(EqualMaskNeon(data + i, value)) != 0) {
+            return i + FindScalar(data + i, 4, value);
+        }
+    }
+    return i + FindScalar(data + i, n - i, value);
+}
+
+template <typename T>
+size_t CountNeon(const T* data, size_t n, T value) noexcept {
+    // Дорожка 32-битного счётчика прибавляет не больше единицы за итерацию, поэтому счётчики
+    // сбрасываются в 64-битную сумму раньше, чем какой-нибудь из них переполнится
+    constexpr size_t FLUSH_PERIOD = size_t{1} << 30;
+    uint64x2_t totals = vdupq_n_u64(0);
+    size_t i = 0;
+    while (i + 4 <= n) {
+        uint32x4_t counts = vdupq_n_u32(0);
+        const size_t block_end = i + std::min((n - i) / 4, FLUSH_PERIOD) * 4;
+        for (; i < block_end; i += 4) {
+            // Совпадение даёт в дорожке все единицы, то есть -1
+            counts = vsubq_u32(counts, EqualMaskNeon(data + i, value));
+        }
+        totals = vpadalq_u32(totals, counts);
+    }
+    return static_cast<size_t>(vaddvq_u64(totals)) + CountScalar(data + i, n - i, value);
+}
+
+inline std::pair<int32_t, int32_t> MinMaxNeon(const int32_t* data, size_t n) noexcept {
+    if (n < 4) {
+        return MinMaxScalar(data, n);
+    }
+    int32x4_t min = vld1q_s32(data);
+    int32x4_t max = min;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        const int32x4_t chunk = vld1q_s32(data + i);
+        min = vminq_s32(min, chunk);
+        max = vmaxq_s32(max, chunk);
+    }
+    std::pair<int32_t, int32_t> result{vminvq_s32(min), vmaxvq_s32(max)};
+    if (i < n) {
+        const auto tail = MinMaxScalar(data + i, n - i);
+        result = {std::min(result.first, tail.first), std::max(result.second, tail.second)};
+    }
+    return result;
+}
+
+inline std::pair<uint32_t, uint32_t> MinMaxNeon(const uint32_t* data, size_t n) noexcept {
+    if (n < 4) {
+        return MinMaxScalar(data, n);
+    }
+    uint32x4_t min = vld1q_u32(data);
+    uint32x4_t max = min;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        const uint32x4_t chunk = vld1q_u32(data + i);
+        min = vminq_u32(min, chunk);
+        max = vmaxq_u32(max, chunk);
+    }
+    std::pair<uint32_t, uint32_t> result{vminvq_u32(min), vmaxvq_u32(max)};
+    if (i < n) {
+        const auto tail = MinMaxScalar(data + i, n - i);
+        result = {std::min(result.first, tail.first), std::max(result.second, tail.second)};
+    }
+    return result;
+}
+
+inline std::pair<float, float> MinMaxNeon(const float* data, size_t n) noexcept {
+    if (n < 4) {
+        return MinMaxScalar(data, n);
+    }
+    float32x4_t min = vld1q_f32(data);
+    float32x4_t max = min;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t chunk = vld1q_f32(data + i);
+        min = vminq_f32(min, chunk);
+        max = vmaxq_f32(max, chunk);
+    }
+    std::pair<float, float> result{vminvq_f32(min), vmaxvq_f32(max)};
+    if (i < n) {
+        const auto tail = MinMaxScalar(data + i, n - i);
+        result = {std::min(result.first, tail.first), std::max(result.second, tail.second)};
+    }
+    return result;
+}
+
+#endif  // ADVANCED_VECTOR_NEON
+
+// uint32_t сравнивается на равенство так же, как int32_t
+template <typename T>
+auto AsKernelType(const T* data) noexcept {
+    if constexpr (std::is_same_v<T, uint32_t>) {
+        return reinterpret_cast<const int32_t*>(data);
+    } else {
+        return data;
+    }
+}
+
+template <typename T>
+size_t Find(const T* data, size_t n, T value) noexcept {
+    if constexpr (HAS_KERNELS<T>) {
+        const auto* kernel_data = AsKernelType(data);
+        const auto kernel_value = static_cast<std::remove_cvref_t<decltype(*kernel_data)>>(value);
+#ifdef ADVANCED_VECTOR_X86
+        switch (GetIsa()) {
+            case Isa::AVX512:
+                return FindAvx512(kernel_data, n, kernel_value);
+            case Isa::AVX2:
+                return FindAvx2(kernel_data, n, kernel_value);
+            case Isa::SCALAR:
+                break;
+        }
+#elif defined(ADVANCED_VECTOR_NEON)
+        return FindNeon(kernel_data, n, kernel_value);
+#endif
+        return FindScalar(kernel_data, n, kernel_value);
+    } else if constexpr (sizeof(T) == 1 && std::is_integral_v<T>) {
+        const void* found = n != 0 ? std::memchr(data, static_cast<unsigned char>(value), n) : nullptr;
+        return found != nullptr ? static_cast<size_t>(static_cast<const T*>(found) - data) : n;
+    } else {
+        return FindScalar(data, n, value);
+    }
+}
+
+template <typename T>
+size_t Count(const T* data, size_t n, T value) noexcept {
+    if constexpr (HAS_KERNELS<T>) {
+        const auto* kernel_data = AsKernelType(data);
+        const auto kernel_value = static_cast<std::remove_cvref_t<decltype(*kernel_data)>>(value);
+#ifdef ADVANCED_VECTOR_X86
+        switch (GetIsa()) {
+            case Isa::AVX512:
+                return CountAvx512(kernel_data, n, kernel_value);
+            case Isa::AVX2:
+                return CountAvx2(kernel_data, n, kernel_value);
+            case Isa::SCALAR:
+                break;
+        }
+#elif defined(ADVANCED_VECTOR_NEON)
+        return CountNeon(kernel_data, n, kernel_value);
+#endif
+        return CountScalar(kernel_data, n, kernel_value);
+    } else {
+        return CountScalar(data, n, value);
+    }
+}
+
+template <typename T>
+std::pair<T, T> MinMax(const T* data, size_t n) noexcept {
+    if constexpr (HAS_KERNELS<T>) {
+#ifdef ADVANCED_VECTOR_X86
+        // Для минимума и максимума AVX2 достаточно: узкое место — чтение памяти
+        if (GetIsa() != Isa::SCALAR) {
+            return MinMaxAvx2(data, n);
+        }
+#elif defined(ADVANCED_VECTOR_NEON)
+        return MinMaxNeon(data, n);
+#endif
+    }
+    return MinMaxScalar(data, n);
+}
+
+}  // namespace detail::simd
+
+template <std::ranges::contiguous_range Range>
+auto Find(Range& range, const std::ranges::range_value_t<Range>& value) {
+    const size_t index = detail::simd::Find(std::ranges::data(range), std::ranges::size(range), value);
+    return std::ranges::begin(range) + index;
+}
+
+template <std::ranges::contiguous_range Range>
+size_t Count(const Range& range, const std::ranges::range_value_t<Range>& value) {
+    return detail::simd::Count(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+template <std::ranges::contiguous_range Range>
+bool Contains(const Range& range, const std::ranges::range_value_t<Range>& value) {
+    return Find(range, value) != std::ranges::end(range);
+}
+
+// Компиляторы векторизуют заполнение сами; для однобайтовых типов используется memset
+template <std::ranges::contiguous_range Range>
+void Fill(Range& range, const std::ranges::range_value_t<Range>& value) {
+    using T = std::ranges::range_value_t<Range>;
+    if constexpr (sizeof(T) == 1 && std::is_integral_v<T>) {
+        if (const size_t n = std::ranges::size(range); n != 0) {
+            std::memset(std::ranges::data(range), static_cast<unsigned char>(value), n);
+        }
+    } else {
+        std::fill_n(std::ranges::data(range), std::ranges::size(range), value);
+    }
+}
+
+// Минимальный и максимальный элементы непустой последовательности. Для float
+// результат не определён, если последовательность содержит NaN.
+template <std::ranges::contiguous_range Range>
+auto MinMax(const Range& range) {
+    assert(std::ranges::size(range) > 0);
+    return detail::simd::MinMax(std::ranges::data(range), std::ranges::size(range));
+}
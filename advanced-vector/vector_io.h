@@ -0,0 +1,358 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Заголовок двоичного представления вектора. Элементы записываются байтами своей памяти,
+// поэтому данные переносимы только между процессами одной архитектуры.
+struct VectorStreamHeader {
+    static constexpr uint64_t MAGIC = 0x4d41455254535641;  // "AVSTREAM"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    // Число элементов заранее неизвестно: они идут до конца данных
+    static constexpr uint64_t UNBOUNDED = UINT64_MAX;
+
+    uint64_t magic = MAGIC;
+    uint32_t format_version = FORMAT_VERSION;
+    uint32_t element_alignment = 0;
+    uint64_t element_size = 0;
+    uint64_t size = 0;
+};
+
+namespace detail {
+
+template <typename T>
+VectorStreamHeader MakeStreamHeader(uint64_t size) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be serialized");
+    VectorStreamHeader header;
+    header.element_alignment = alignof(T);
+    header.element_size = sizeof(T);
+    header.size = size;
+    return header;
+}
+
+template <typename T>
+void CheckStreamHeader(const VectorStreamHeader& header) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be serialized");
+    if (header.magic != VectorStreamHeader::MAGIC || header.format_version != VectorStreamHeader::FORMAT_VERSION) {
+        throw std::runtime_error("not a serialized vector");
+    }
+    if (header.element_size != sizeof(T) || header.element_alignment != alignof(T)) {
+        throw std::runtime_error("serialized vector: element layout mismatch");
+    }
+}
+
+// Приёмники и источники байтов: файловый дескриптор или поток iostream.
+// WriteAll записывает два отрезка подряд, ReadSome возвращает 0 только в конце данных.
+
+#ifdef __linux__
+
+// Оба отрезка уходят одним writev; частичная запись продолжается с места остановки
+inline void WriteAll(int fd, const void* first, size_t first_bytes, const void* second, size_t second_bytes) {
+    iovec parts[2] = {{const_cast<void*>(first), first_bytes}, {const_cast<void*>(second), second_bytes}};
+    iovec* part = parts;
+    int count = 2;
+    while (count > 0) {
+        const ssize_t written = writev(fd, part, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        size_t rest = static_cast<size_t>(written);
+        for (; count > 0 && rest >= part->iov_len; ++part, --count) {
+            rest -= part->iov_len;
+        }
+        if (count > 0) {
+            part->iov_base = static_cast<std::byte*>(part->iov_base) + rest;
+            part->iov_len -= rest;
+        }
+    }
+}
+
+inline size_t ReadSome(int fd, void* buf, size_t bytes) {
+    while (true) {
+        const ssize_t got = read(fd, buf, bytes);
+        if (got >= 0) {
+            return static_cast<size_t>(got);
+        }
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+    }
+}
+
+#endif  // __linux__
+
+inline void WriteAll(std::ostream& out, const void* first, size_t first_bytes, const void* second,
+                     size_t second_bytes) {
+    out.write(static_cast<const char*>(first), static_cast<std::streamsize>(first_bytes));
+    out.write(static_cast<const char*>(second), static_cast<std::streamsize>(second_bytes));
+    if (!out) {
+        throw std::ios_base::failure("serialized vector: write failed");
+    }
+}
+
+inline size_t ReadSome(std::istream& in, void* buf, size_t bytes) {
+    in.read(static_cast<char*>(buf), static_cast<std::streamsize>(bytes));
+    if (in.bad()) {
+        throw std::ios_base::failure("serialized vector: read failed");
+    }
+    return static_cast<size_t>(in.gcount());
+}
+
+// Читает bytes байтов или меньше, если данные закончились раньше
+template <typename Source>
+size_t ReadFull(Source& source, void* buf, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        const size_t got = ReadSome(source, static_cast<std::byte*>(buf) + total, bytes - total);
+        if (got == 0) {
+            break;
+        }
+        total += got;
+    }
+    return total;
+}
+
+template <typename Source, typename T>
+void ReadStreamHeader(Source& source, VectorStreamHeader& header) {
+    if (ReadFull(source, &header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("not a serialized vector");
+    }
+    CheckStreamHeader<T>(header);
+}
+
+template <typename Sink, typename T, typename Alloc, typename Growth, typename Stats>
+void WriteVector(Sink& sink, const Vector<T, Alloc, Growth, Stats>& v) {
+    const VectorStreamHeader header = MakeStreamHeader<T>(v.Size());
+    WriteAll(sink, &header, sizeof(header), v.begin(), v.Size() * sizeof(T));
+}
+
+// Элементы читаются прямо в буфер нового вектора, который затем обменивается с v.
+// Если размер неизвестен, буфер растёт по политике Growth, а чтение идёт в его свободную часть.
+template <typename Source, typename T, typename Alloc, typename Growth, typename Stats>
+void ReadVector(Source& source, Vector<T, Alloc, Growth, Stats>& v) {
+    VectorStreamHeader header;
+    ReadStreamHeader<Source, T>(source, header);
+    Vector<T, Alloc, Growth, Stats> result(v.GetAllocator());
+    if (header.size != VectorStreamHeader::UNBOUNDED) {
+        result.ResizeAndOverwrite(static_cast<size_t>(header.size), [&source](T* data, size_t n) {
+            if (ReadFull(source, data, n * sizeof(T)) != n * sizeof(T)) {
+                throw std::runtime_error("serialized vector is truncated");
+            }
+            return n;
+        });
+    } else {
+        for (bool at_end = false; !at_end;) {
+            if (result.Size() == result.Capacity()) {
+                result.Reserve(Growth::template NextCapacity<T>(result.Capacity()));
+            }
+            const size_t old_size = result.Size();
+            result.ResizeAndOverwrite(result.Capacity(), [&source, &at_end, old_size](T* data, size_t n) {
+                const size_t bytes = (n - old_size) * sizeof(T);
+                const size_t got = ReadFull(source, data + old_size, bytes);
+                if (got % sizeof(T) != 0) {
+                    throw std::runtime_error("serialized vector is truncated");
+                }
+                at_end = got < bytes;
+                return old_size + got / sizeof(T);
+            });
+        }
+    }
+    v.Swap(result);
+}
+
+}  // namespace detail
+
+// WriteTo записывает заголовок и все элементы, в дескриптор — одним вызовом writev.
+// ReadFrom заменяет содержимое v прочитанным; при исключении v не изменяется.
+
+#ifdef __linux__
+
+template <typename T, typename Alloc, typename Growth, typename Stats>
+void WriteTo(int fd, const Vector<T, Alloc, Growth, Stats>& v) {
+    detail::WriteVector(fd, v);
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats>
+void ReadFrom(int fd, Vector<T, Alloc, Growth, Stats>& v) {
+    detail::ReadVector(fd, v);
+}
+
+#endif  // __linux__
+
+template <typename T, typename Alloc, typename Growth, typename Stats>
+void WriteTo(std::ostream& out, const Vector<T, Alloc, Growth, Stats>& v) {
+    detail::WriteVector(out, v);
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats>
+void ReadFrom(std::istream& in, Vector<T, Alloc, Growth, Stats>& v) {
+    detail::ReadVector(in, v);
+}
+
+// Потоковая запись, когда число элементов заранее неизвестно: Append отправляет элементы
+// сразу, без накопления. Результат читается ReadFrom или VectorStreamReader.
+// Дескриптор или поток должен жить дольше объекта и не закрывается им.
+template <typename T>
+class VectorStreamWriter {
+public:
+#ifdef __linux__
+    explicit VectorStreamWriter(int fd)
+        : fd_(fd) {
+        WriteHeader();
+    }
+#endif
+
+    explicit VectorStreamWriter(std::ostream& out)
+        : out_(&out) {
+        WriteHeader();
+    }
+
+    void Append(std::span<const T> values) {
+        Write(values.data(), values.size_bytes());
+    }
+
+private:
+    void WriteHeader() {
+        const VectorStreamHeader header = detail::MakeStreamHeader<T>(VectorStreamHeader::UNBOUNDED);
+        Write(&header, sizeof(header));
+    }
+
+    void Write(const void* data, size_t bytes) {
+#ifdef __linux__
+        if (out_ == nullptr) {
+            detail::WriteAll(fd_, data, bytes, nullptr, 0);
+            return;
+        }
+#endif
+        detail::WriteAll(*out_, data, bytes, nullptr, 0);
+    }
+
+    int fd_ = -1;
+    std::ostream* out_ = nullptr;
+};
+
+// Потоковое чтение частями: ReadInto дописывает очередные элементы прямо в свободную
+// ёмкость вектора, поэтому обработку можно начать до конца данных, а временный буфер
+// на все данные не нужен. Читает и данные WriteTo, и данные VectorStreamWriter.
+template <typename T>
+class VectorStreamReader {
+public:
+#ifdef __linux__
+    explicit VectorStreamReader(int fd)
+        : fd_(fd) {
+        ReadHeader();
+    }
+#endif
+
+    explicit VectorStreamReader(std::istream& in)
+        : in_(&in) {
+        ReadHeader();
+    }
+
+    // Дописывает в v не больше max_count элементов: сколько пришло за одно чтение, но хотя бы
+    // один, если данные не закончились. Возвращает число добавленных элементов, 0 — конец данных.
+    // Если чтение не удалось, v не изменяется.
+    template <typename Alloc, typename Growth, typename Stats>
+    size_t ReadInto(Vector<T, Alloc, Growth, Stats>& v, size_t max_count) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(max_count, remaining_));
+        if (at_end_ || count == 0) {
+            at_end_ = at_end_ || remaining_ == 0;
+            return 0;
+        }
+        const size_t old_size = v.Size();
+        if (old_size + count > v.Capacity()) {
+            v.Reserve(std::max(old_size + count, Growth::template NextCapacity<T>(v.Capacity())));
+        }
+        size_t appended = 0;
+        try {
+            v.ResizeAndOverwrite(old_size + count, [this, old_size, count, &appended](T* data, size_t /*n*/) {
+                appended = ReadElements(reinterpret_cast<std::byte*>(data + old_size), count * sizeof(T));
+                return old_size + appended;
+            });
+        } catch (...) {
+            v.Resize(old_size);
+            throw;
+        }
+        if (remaining_ != VectorStreamHeader::UNBOUNDED) {
+            remaining_ -= appended;
+        }
+        if (at_end_ && (pending_bytes_ != 0 || (remaining_ != VectorStreamHeader::UNBOUNDED && remaining_ != 0))) {
+            // Прочитанные перед обрывом элементы тоже отбрасываются
+            v.Resize(old_size);
+            throw std::runtime_error("serialized vector is truncated");
+        }
+        at_end_ = at_end_ || remaining_ == 0;
+        return appended;
+    }
+
+    bool AtEnd() const noexcept {
+        return at_end_;
+    }
+
+private:
+    void ReadHeader() {
+        VectorStreamHeader header;
+        if (in_ != nullptr) {
+            detail::ReadStreamHeader<std::istream, T>(*in_, header);
+        } else {
+#ifdef __linux__
+            detail::ReadStreamHeader<int, T>(fd_, header);
+#endif
+        }
+        remaining_ = header.size;
+    }
+
+    size_t ReadSome(void* buf, size_t bytes) {
+#ifdef __linux__
+        if (in_ == nullptr) {
+            return detail::ReadSome(fd_, buf, bytes);
+        }
+#endif
+        return detail::ReadSome(*in_, buf, bytes);
+    }
+
+    // Читает в out не больше bytes байтов, пока не наберётся целый элемент. Начало неполного
+    // элемента сохраняется до следующего вызова. Возвращает число целых элементов.
+    size_t ReadElements(std::byte* out, size_t bytes) {
+        std::memcpy(out, pending_, pending_bytes_);
+        size_t filled = pending_bytes_;
+        while (filled < sizeof(T)) {
+            const size_t got = ReadSome(out + filled, bytes - filled);
+            if (got == 0) {
+                at_end_ = true;
+                break;
+            }
+            filled += got;
+        }
+        const size_t elements = filled / sizeof(T);
+        pending_bytes_ = filled % sizeof(T);
+        std::memcpy(pending_, out + elements * sizeof(T), pending_bytes_);
+        return elements;
+    }
+
+    int fd_ = -1;
+    std::istream* in_ = nullptr;
+    uint64_t remaining_ = 0;
+    std::byte pending_[sizeof(T)] = {};
+    size_t pending_bytes_ = 0;
+    bool at_end_ = false;
+};